@@ -2,12 +2,14 @@
 
 #include "Application.h"
 #include "ApplicationContext.h"
+#include "BatchBuilder.h"
 #include "CameraSystem.h"
 #include "GeodataContext.h"
 #include "GeodataSystem.h"
 #include "LoadingSystem.h"
 #include "RenderingContext.h"
 #include "RenderingSystem.h"
+#include "SettingsParser.h"
 #include "UIContext.h"
 #include "UISystem.h"
 #include "WindowContext.h"
@@ -17,9 +19,12 @@ Application::Application(const std::vector<std::string> &arguments)
     : m_arguments{arguments} {}
 
 auto Application::run() -> int {
+  if (!m_arguments.empty() && m_arguments[0] == "--batch") {
+    return run_batch();
+  }
+
   if (m_arguments.size() < 2) {
-    std::cout << "Usage:" << std::endl;
-    std::cout << "\tl2mapconv <L2 root path> [<map package name>]" << std::endl;
+    print_usage();
     return EXIT_FAILURE;
   }
 
@@ -95,3 +100,79 @@ auto Application::run() -> int {
 
   return EXIT_SUCCESS;
 }
+
+auto Application::run_batch() -> int {
+  geodata::BuilderSettings settings{};
+  SettingsParser settings_parser;
+  std::filesystem::path output_path = "output";
+  std::vector<std::string> positional_arguments;
+
+  for (auto argument = m_arguments.begin() + 1; argument != m_arguments.end();
+       ++argument) {
+
+    if (!argument->starts_with("--")) {
+      positional_arguments.push_back(*argument);
+      continue;
+    }
+
+    const auto separator = argument->find('=');
+
+    if (separator == std::string::npos) {
+      utils::Log(utils::LOG_ERROR)
+          << "Option value expected: " << *argument << std::endl;
+      print_usage();
+      return EXIT_FAILURE;
+    }
+
+    const auto key = argument->substr(2, separator - 2);
+    const auto value = argument->substr(separator + 1);
+
+    if (key == "config") {
+      if (!settings_parser.parse_file(value, settings)) {
+        return EXIT_FAILURE;
+      }
+    } else if (key == "output") {
+      output_path = value;
+    } else if (!settings_parser.parse_option(key, value, settings)) {
+      print_usage();
+      return EXIT_FAILURE;
+    }
+  }
+
+  if (positional_arguments.empty()) {
+    print_usage();
+    return EXIT_FAILURE;
+  }
+
+  const auto root_path = positional_arguments[0];
+
+  if (!std::filesystem::exists(root_path)) {
+    utils::Log(utils::LOG_ERROR)
+        << "L2 root path not found: " << root_path << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  std::filesystem::create_directories(output_path);
+
+  auto map_names = positional_arguments;
+  map_names.erase(map_names.begin());
+
+  BatchBuilder batch_builder{root_path, output_path, settings};
+  return batch_builder.build(map_names) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+void Application::print_usage() const {
+  std::cout << "Usage:" << std::endl;
+  std::cout << "\tl2mapconv <L2 root path> [<map package name>]" << std::endl;
+  std::cout << "\tl2mapconv --batch [--config=<path>] [--output=<path>] "
+               "[--<setting>=<value>] <L2 root path> [<map package name>]"
+            << std::endl;
+  std::cout << std::endl;
+  std::cout << "Batch mode builds all maps from MAPS directory if no map "
+               "package names given."
+            << std::endl;
+  std::cout << "Settings: cell-size, cell-height, walkable-height, wall-angle, "
+               "walkable-angle, min-walkable-climb, max-walkable-climb, "
+               "tile-size, thread-count."
+            << std::endl;
+}
@@ -11,4 +11,9 @@ public:
 
 private:
   const std::vector<std::string> m_arguments;
+
+  // Builds geodata without window.
+  auto run_batch() -> int;
+
+  void print_usage() const;
 };
@@ -0,0 +1,107 @@
+#include "pch.h"
+
+#include "BatchBuilder.h"
+#include "GeodataMapFactory.h"
+
+BatchBuilder::BatchBuilder(const std::filesystem::path &root_path,
+                           const std::filesystem::path &output_path,
+                           const geodata::BuilderSettings &settings)
+    : m_root_path{root_path}, m_settings{settings},
+      m_unreal_loader{root_path, unreal::LoadProfile::CollisionOnly},
+      m_map_cache{"cache", unreal::LoadProfile::CollisionOnly},
+      m_geodata_exporter{output_path} {}
+
+auto BatchBuilder::build(const std::vector<std::string> &map_names) const
+    -> bool {
+
+  const auto names = map_names.empty() ? find_map_names() : map_names;
+
+  if (names.empty()) {
+    utils::Log(utils::LOG_ERROR, "App") << "No maps to build" << std::endl;
+    return false;
+  }
+
+  auto failed = 0;
+
+  for (const auto &map_name : names) {
+    if (!build_map(map_name)) {
+      failed++;
+    }
+  }
+
+  utils::Log(utils::LOG_INFO, "App")
+      << "Built " << names.size() - failed << " of " << names.size()
+      << " maps" << std::endl;
+
+  return failed == 0;
+}
+
+auto BatchBuilder::build_map(const std::string &map_name) const -> bool {
+  utils::Log(utils::LOG_INFO, "App")
+      << "Loading map: " << map_name << std::endl;
+
+  auto map = m_map_cache.load(map_name).value_or(Map{});
+
+  if (map.entities.empty()) {
+    std::vector<std::filesystem::path> dependencies;
+    map = m_unreal_loader.load_map(map_name, dependencies);
+    map.name = map_name;
+
+    if (!map.entities.empty()) {
+      m_map_cache.save(map, dependencies);
+    }
+  }
+
+  if (map.entities.empty()) {
+    utils::Log(utils::LOG_ERROR, "App")
+        << "Nothing to build in map: " << map_name << std::endl;
+    return false;
+  }
+
+  GeodataMapFactory geodata_map_factory;
+  const auto geodata_map = geodata_map_factory.make_map(map);
+
+  utils::Log(utils::LOG_INFO, "App")
+      << "Building geodata for map: " << map_name << std::endl;
+
+  const auto geodata = m_geodata_builder.build(geodata_map, m_settings);
+
+  utils::Log(utils::LOG_INFO, "App")
+      << "Exporting geodata for map: " << map_name << std::endl;
+
+  m_geodata_exporter.export_l2j_geodata(map_name, geodata);
+
+  return true;
+}
+
+auto BatchBuilder::find_map_names() const -> std::vector<std::string> {
+  std::vector<std::string> map_names;
+
+  // Only regions (X_Y) have terrain and geodata.
+  const std::regex region_name{R"(\d+_\d+)"};
+
+  const auto maps_path = m_root_path / "MAPS";
+
+  if (!std::filesystem::exists(maps_path)) {
+    utils::Log(utils::LOG_ERROR, "App")
+        << "Maps directory not found: " << maps_path << std::endl;
+    return map_names;
+  }
+
+  for (const auto &entry : std::filesystem::directory_iterator{maps_path}) {
+    const auto &path = entry.path();
+    auto extension = path.extension().string();
+    std::transform(extension.begin(), extension.end(), extension.begin(),
+                   [](unsigned char c) { return std::tolower(c); });
+
+    if (!entry.is_regular_file() || extension != ".unr" ||
+        !std::regex_match(path.stem().string(), region_name)) {
+      continue;
+    }
+
+    map_names.push_back(path.stem().string());
+  }
+
+  std::sort(map_names.begin(), map_names.end());
+  return map_names;
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include "MapCache.h"
+#include "UnrealLoader.h"
+
+#include <geodata/Builder.h>
+#include <geodata/BuilderSettings.h>
+#include <geodata/Exporter.h>
+
+#include <filesystem>
+#include <string>
+#include <vector>
+
+// Builds and exports geodata without window and rendering.
+class BatchBuilder {
+public:
+  explicit BatchBuilder(const std::filesystem::path &root_path,
+                        const std::filesystem::path &output_path,
+                        const geodata::BuilderSettings &settings);
+
+  // Builds all maps from MAPS directory if no map names given.
+  auto build(const std::vector<std::string> &map_names) const -> bool;
+
+private:
+  std::filesystem::path m_root_path;
+  geodata::BuilderSettings m_settings;
+  UnrealLoader m_unreal_loader;
+  MapCache m_map_cache;
+  geodata::Builder m_geodata_builder;
+  geodata::Exporter m_geodata_exporter;
+
+  auto build_map(const std::string &map_name) const -> bool;
+  auto find_map_names() const -> std::vector<std::string>;
+};
@@ -0,0 +1,64 @@
+#include "pch.h"
+
+#include "GeodataMapFactory.h"
+
+auto GeodataMapFactory::make_map(const Map &map) -> geodata::Map {
+  geodata::Map geodata_map{map.name, map.bounding_box};
+  geodata_map.set_heightmap(map.heightmap);
+
+  for (const auto &entity : map.entities) {
+    // Load mesh if needed.
+    auto cached_mesh = m_mesh_cache.find(entity.mesh);
+
+    if (cached_mesh == m_mesh_cache.end()) {
+      cached_mesh =
+          m_mesh_cache.insert({entity.mesh, make_mesh(entity)}).first;
+    }
+
+    if (cached_mesh->second == nullptr) {
+      continue;
+    }
+
+    geodata::Entity geodata_entity{
+        cached_mesh->second,
+        entity.model_matrix(),
+    };
+
+    geodata_map.add(geodata_entity);
+  }
+
+  return geodata_map;
+}
+
+auto GeodataMapFactory::make_mesh(const Entity<EntityMesh> &entity) const
+    -> std::shared_ptr<geodata::Mesh> {
+
+  std::vector<unsigned int> indices;
+
+  for (const auto &surface : entity.mesh->surfaces) {
+    // Terrain is built from map heightmap.
+    if ((surface.type &
+         (SURFACE_PASSABLE | SURFACE_BOUNDING_BOX | SURFACE_TERRAIN)) != 0) {
+      continue;
+    }
+
+    indices.insert(indices.end(),
+                   entity.mesh->indices.begin() + surface.index_offset,
+                   entity.mesh->indices.begin() + surface.index_offset +
+                       surface.index_count);
+  }
+
+  if (entity.mesh->vertices.empty() || indices.empty()) {
+    return nullptr;
+  }
+
+  // Vertices are shared with the render mesh, only indices are filtered.
+  const auto mesh = std::make_shared<geodata::Mesh>();
+  mesh->vertices = geodata::VertexBuffer{
+      std::shared_ptr<const std::vector<Vertex>>{entity.mesh,
+                                                 &entity.mesh->vertices}};
+  mesh->indices.swap(indices);
+  mesh->instance_matrices = entity.instance_matrices();
+
+  return mesh;
+}
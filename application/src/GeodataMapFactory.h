@@ -0,0 +1,23 @@
+#pragma once
+
+#include "Entity.h"
+#include "Map.h"
+
+#include <geodata/Entity.h>
+#include <geodata/Map.h>
+
+#include <memory>
+#include <unordered_map>
+
+class GeodataMapFactory {
+public:
+  auto make_map(const Map &map) -> geodata::Map;
+
+private:
+  std::unordered_map<std::shared_ptr<EntityMesh>,
+                     std::shared_ptr<geodata::Mesh>>
+      m_mesh_cache;
+
+  auto make_mesh(const Entity<EntityMesh> &entity) const
+      -> std::shared_ptr<geodata::Mesh>;
+};
@@ -10,9 +10,28 @@ GeodataSystem::GeodataSystem(GeodataContext &geodata_context,
       m_renderer{renderer}, m_geodata_exporter{"output"} {
 
   m_ui_context.geodata.build_handler = [this] { build(); };
+  m_ui_context.geodata.cancel_handler = [this] { cancel(); };
 }
 
-void GeodataSystem::build() const {
+void GeodataSystem::frame_begin(Timestep /*frame_time*/) {
+  if (m_build_pool == nullptr) {
+    return;
+  }
+
+  render_results();
+  update_status();
+}
+
+void GeodataSystem::stop() {
+  cancel();
+  m_build_pool = nullptr;
+}
+
+void GeodataSystem::build() {
+  if (m_build_pool != nullptr) {
+    return;
+  }
+
   geodata::BuilderSettings settings{};
   settings.cell_size = m_ui_context.geodata.cell_size;
   settings.cell_height = m_ui_context.geodata.cell_height;
@@ -21,27 +40,149 @@ void GeodataSystem::build() const {
   settings.walkable_angle = m_ui_context.geodata.walkable_angle;
   settings.min_walkable_climb = m_ui_context.geodata.min_walkable_climb;
   settings.max_walkable_climb = m_ui_context.geodata.max_walkable_climb;
+  settings.tile_size = m_ui_context.geodata.tile_size;
+  settings.thread_count = m_ui_context.geodata.thread_count;
 
-  geodata::Builder geodata_builder;
-  GeodataEntityFactory geodata_entity_factory;
+  // Each map build is limited in memory, so bound the number of maps built at
+  // once and share cores between them.
+  const auto concurrent_builds =
+      std::max(m_ui_context.geodata.concurrent_builds, 1);
+
+  if (settings.thread_count <= 0) {
+    settings.thread_count =
+        std::max(static_cast<int>(std::thread::hardware_concurrency()) /
+                     concurrent_builds,
+                 1);
+  }
 
   m_renderer.remove(SURFACE_EXPORTED_GEODATA);
 
+  m_builds.clear();
+  m_results.clear();
+  m_build_pool = std::make_unique<utils::ThreadPool>(concurrent_builds);
+
+  const auto export_ = m_ui_context.geodata.export_;
+
   for (const auto &map : m_geodata_context.maps) {
+    auto &build = *m_builds.emplace_back(std::make_unique<MapBuild>(map));
+
+    m_build_pool->submit([this, &build, settings, export_] {
+      build_map(build, settings, export_);
+    });
+  }
+
+  update_status();
+}
+
+void GeodataSystem::cancel() {
+  for (const auto &build : m_builds) {
+    build->progress.cancelled = true;
+  }
+}
+
+void GeodataSystem::build_map(MapBuild &build,
+                              const geodata::BuilderSettings &settings,
+                              bool export_) {
+
+  // Task result is discarded, so failed build must not leave the state as
+  // unfinished.
+  try {
+    build_map_geodata(build, settings, export_);
+  } catch (const std::exception &exception) {
+    utils::Log(utils::LOG_ERROR, "App")
+        << "Can't build geodata for map: " << build.map.name() << ": "
+        << exception.what() << std::endl;
+    build.state = GEODATA_BUILD_FAILED;
+  }
+}
+
+void GeodataSystem::build_map_geodata(MapBuild &build,
+                                      const geodata::BuilderSettings &settings,
+                                      bool export_) {
+
+  if (build.progress.cancelled) {
+    build.state = GEODATA_BUILD_CANCELLED;
+    return;
+  }
+
+  utils::Log(utils::LOG_INFO, "App")
+      << "Building geodata for map: " << build.map.name() << std::endl;
+
+  build.state = GEODATA_BUILD_BUILDING;
+
+  auto geodata = m_geodata_builder.build(build.map, settings, &build.progress);
+
+  if (build.progress.cancelled) {
+    build.state = GEODATA_BUILD_CANCELLED;
+    return;
+  }
+
+  if (export_) {
     utils::Log(utils::LOG_INFO, "App")
-        << "Building geodata for map: " << map.name() << std::endl;
+        << "Exporting geodata for map: " << build.map.name() << std::endl;
+
+    build.state = GEODATA_BUILD_EXPORTING;
+    m_geodata_exporter.export_l2j_geodata(build.map.name(), geodata);
+  }
+
+  {
+    std::lock_guard lock{m_results_mutex};
+    m_results.emplace_back(&build.map, std::move(geodata));
+  }
+
+  build.state = GEODATA_BUILD_DONE;
+}
+
+void GeodataSystem::render_results() {
+  std::vector<std::pair<const geodata::Map *, geodata::Geodata>> results;
+
+  {
+    std::lock_guard lock{m_results_mutex};
+    results.swap(m_results);
+  }
 
-    const auto geodata = geodata_builder.build(map, settings);
+  GeodataEntityFactory geodata_entity_factory;
+
+  for (const auto &[map, geodata] : results) {
     const auto geodata_entity = geodata_entity_factory.make_entity(
-        geodata, map.bounding_box(), SURFACE_EXPORTED_GEODATA);
+        geodata, map->bounding_box(), SURFACE_EXPORTED_GEODATA);
 
     m_renderer.render_geodata({geodata_entity});
+  }
+}
+
+void GeodataSystem::update_status() {
+  auto &statuses = m_ui_context.geodata.builds;
+  statuses.clear();
+
+  auto finished = true;
+
+  for (const auto &build : m_builds) {
+    const auto state = build->state.load();
+    const auto total_tiles = build->progress.total_tiles.load();
 
-    if (m_ui_context.geodata.export_) {
-      utils::Log(utils::LOG_INFO, "App")
-          << "Exporting geodata for map: " << map.name() << std::endl;
+    auto progress = 0.0f;
 
-      m_geodata_exporter.export_l2j_geodata(map.name(), geodata);
+    if (state == GEODATA_BUILD_DONE || state == GEODATA_BUILD_EXPORTING) {
+      progress = 1.0f;
+    } else if (total_tiles > 0) {
+      progress = static_cast<float>(build->progress.built_tiles) /
+                 static_cast<float>(total_tiles);
     }
+
+    statuses.push_back({build->map.name(), state, progress});
+
+    if (state != GEODATA_BUILD_DONE && state != GEODATA_BUILD_CANCELLED &&
+        state != GEODATA_BUILD_FAILED) {
+      finished = false;
+    }
+  }
+
+  m_ui_context.geodata.building = !finished;
+
+  if (finished) {
+    // Results of the last builds are pushed before they are marked as done.
+    render_results();
+    m_build_pool = nullptr;
   }
 }
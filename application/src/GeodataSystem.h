@@ -6,18 +6,61 @@
 #include "Timestep.h"
 #include "UIContext.h"
 
+#include <utils/ThreadPool.h>
+
+#include <geodata/BuildProgress.h>
+#include <geodata/Builder.h>
 #include <geodata/Exporter.h>
+#include <geodata/Geodata.h>
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
 
 class GeodataSystem : public System {
 public:
   explicit GeodataSystem(GeodataContext &geodata_context, UIContext &ui_context,
                          const Renderer &renderer);
 
+  virtual void frame_begin(Timestep frame_time) override;
+  virtual void stop() override;
+
 private:
+  struct MapBuild {
+    const geodata::Map &map;
+    std::atomic<GeodataBuildState> state;
+    geodata::BuildProgress progress;
+
+    explicit MapBuild(const geodata::Map &map)
+        : map{map}, state{GEODATA_BUILD_QUEUED} {}
+  };
+
   GeodataContext &m_geodata_context;
   UIContext &m_ui_context;
   const Renderer &m_renderer;
+  geodata::Builder m_geodata_builder;
   geodata::Exporter m_geodata_exporter;
 
-  void build() const;
+  std::vector<std::unique_ptr<MapBuild>> m_builds;
+
+  // Built geodata waiting to be rendered on the main thread.
+  std::mutex m_results_mutex;
+  std::vector<std::pair<const geodata::Map *, geodata::Geodata>> m_results;
+
+  // Must be destroyed first, tasks use everything above.
+  std::unique_ptr<utils::ThreadPool> m_build_pool;
+
+  void build();
+  void cancel();
+
+  void build_map(MapBuild &build, const geodata::BuilderSettings &settings,
+                 bool export_);
+  void build_map_geodata(MapBuild &build,
+                         const geodata::BuilderSettings &settings,
+                         bool export_);
+  void render_results();
+  void update_status();
 };
@@ -1,7 +1,9 @@
 #include "pch.h"
 
 #include "GeodataEntityFactory.h"
+#include "GeodataMapFactory.h"
 #include "LoadingSystem.h"
+#include "MapCache.h"
 #include "UnrealLoader.h"
 
 LoadingSystem::LoadingSystem(GeodataContext &geodata_context,
@@ -11,17 +13,56 @@ LoadingSystem::LoadingSystem(GeodataContext &geodata_context,
     : m_geodata_context{geodata_context}, m_renderer{renderer} {
 
   UnrealLoader unreal_loader{root_path};
+  MapCache map_cache{"cache"};
   geodata::Loader geodata_loader{"geodata"};
   GeodataEntityFactory geodata_entity_factory;
 
   std::vector<Map> maps;
   std::vector<Entity<GeodataMesh>> geodata_entities;
 
+  // Only maps missing in cache need unreal packages.
+  std::vector<std::optional<Map>> cached_maps;
+  std::vector<std::string> missing_map_names;
+
   for (const auto &map_name : map_names) {
+    cached_maps.push_back(map_cache.load(map_name));
+
+    if (!cached_maps.back().has_value()) {
+      missing_map_names.push_back(map_name);
+    }
+  }
+
+  // Missing maps are preloaded in batches fitting the package cache.
+  std::size_t converted_maps = 0;
+  std::size_t preloaded_maps = 0;
+
+  for (std::size_t i = 0; i < map_names.size(); ++i) {
+    const auto &map_name = map_names[i];
+
     // Load map entities.
-    auto map = unreal_loader.load_map(map_name);
-    map.name = map_name;
-    maps.push_back(map);
+    if (cached_maps[i].has_value()) {
+      maps.push_back(std::move(cached_maps[i].value()));
+    } else {
+      if (converted_maps == preloaded_maps) {
+        preloaded_maps += unreal_loader.preload_maps(
+            {missing_map_names.begin() + preloaded_maps,
+             missing_map_names.end()});
+      }
+
+      converted_maps++;
+
+      std::vector<std::filesystem::path> dependencies;
+      auto map = unreal_loader.load_map(map_name, dependencies);
+      map.name = map_name;
+
+      if (!map.entities.empty()) {
+        map_cache.save(map, dependencies);
+      }
+
+      maps.push_back(std::move(map));
+    }
+
+    const auto &map = maps.back();
 
     // Load geodata.
     const auto *geodata = geodata_loader.load_geodata(map_name);
@@ -48,69 +89,13 @@ void LoadingSystem::prebuild_maps(const std::vector<Map> &maps) const {
   utils::Log(utils::LOG_INFO, "App")
       << "Prepare maps for geodata building" << std::endl;
 
-  std::unordered_map<std::shared_ptr<EntityMesh>,
-                     std::shared_ptr<geodata::Mesh>>
-      entity_mesh_cache;
+  GeodataMapFactory geodata_map_factory;
 
   for (const auto &map : maps) {
     if (map.entities.empty()) {
       continue;
     }
 
-    geodata::Map geodata_map{map.name, map.bounding_box};
-
-    for (const auto &entity : map.entities) {
-      // Load mesh if needed.
-      auto cached_mesh = entity_mesh_cache.find(entity.mesh);
-
-      if (cached_mesh == entity_mesh_cache.end()) {
-        std::vector<geodata::Vertex> vertices;
-        std::vector<unsigned int> indices;
-        auto skipped_indices = 0;
-
-        for (const auto &surface : entity.mesh->surfaces) {
-          if ((surface.type & (SURFACE_PASSABLE | SURFACE_BOUNDING_BOX)) != 0) {
-            skipped_indices += surface.index_count;
-            continue;
-          }
-
-          for (auto i = surface.index_offset;
-               i < (surface.index_offset + surface.index_count); ++i) {
-
-            const auto index = entity.mesh->indices[i];
-
-            vertices.push_back({entity.mesh->vertices[index].position,
-                                entity.mesh->vertices[index].normal});
-
-            indices.push_back(i - skipped_indices);
-          }
-        }
-
-        if (vertices.empty() || indices.empty()) {
-          entity_mesh_cache.insert({entity.mesh, nullptr});
-          continue;
-        }
-
-        const auto mesh = std::make_shared<geodata::Mesh>();
-        mesh->vertices.swap(vertices);
-        mesh->indices.swap(indices);
-        mesh->instance_matrices = entity.instance_matrices();
-
-        cached_mesh = entity_mesh_cache.insert({entity.mesh, mesh}).first;
-      }
-
-      if (cached_mesh->second == nullptr) {
-        continue;
-      }
-
-      geodata::Entity geodata_entity{
-          cached_mesh->second,
-          entity.model_matrix(),
-      };
-
-      geodata_map.add(geodata_entity);
-    }
-
-    m_geodata_context.maps.push_back(std::move(geodata_map));
+    m_geodata_context.maps.push_back(geodata_map_factory.make_map(map));
   }
 }
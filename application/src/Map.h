@@ -2,18 +2,23 @@
 
 #include "Entity.h"
 
+#include <geodata/Heightmap.h>
+
 #include <math/Box.h>
 
 #include <glm/glm.hpp>
 
+#include <memory>
 #include <string>
 #include <vector>
 
 struct Map {
   std::string name;
   std::vector<Entity<EntityMesh>> entities;
+  std::shared_ptr<geodata::Heightmap> heightmap;
   glm::vec3 position;
   math::Box bounding_box;
 
-  explicit Map() : name{}, entities{}, position{}, bounding_box{} {}
+  explicit Map()
+      : name{}, entities{}, heightmap{}, position{}, bounding_box{} {}
 };
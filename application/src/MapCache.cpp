@@ -0,0 +1,406 @@
+#include "pch.h"
+
+#include "MapCache.h"
+
+namespace {
+
+struct Dependency {
+  std::string path;
+  std::uint64_t size;
+  std::int64_t time;
+};
+
+auto stat_dependency(const std::filesystem::path &path)
+    -> std::optional<Dependency> {
+
+  std::error_code error;
+
+  const auto size = std::filesystem::file_size(path, error);
+
+  if (error) {
+    return {};
+  }
+
+  const auto time = std::filesystem::last_write_time(path, error);
+
+  if (error) {
+    return {};
+  }
+
+  return Dependency{path.generic_string(), size,
+                    static_cast<std::int64_t>(time.time_since_epoch().count())};
+}
+
+class CacheWriter {
+public:
+  explicit CacheWriter(std::ofstream &output) : m_output{output} {}
+
+  template <typename T> void write(const T &value) {
+    static_assert(std::is_trivially_copyable_v<T>);
+    m_output.write(reinterpret_cast<const char *>(&value), sizeof(value));
+  }
+
+  template <typename T> void write(const std::vector<T> &vector) {
+    static_assert(std::is_trivially_copyable_v<T>);
+    write<std::uint64_t>(vector.size());
+    m_output.write(reinterpret_cast<const char *>(vector.data()),
+                   static_cast<std::streamsize>(vector.size() * sizeof(T)));
+  }
+
+  void write(const std::string &string) {
+    write<std::uint64_t>(string.size());
+    m_output.write(string.data(), static_cast<std::streamsize>(string.size()));
+  }
+
+  void write(const math::Box &box) {
+    write<std::uint8_t>(box.is_valid());
+    write(box.min());
+    write(box.max());
+  }
+
+private:
+  std::ofstream &m_output;
+};
+
+class CacheReader {
+public:
+  explicit CacheReader(const std::uint8_t *data, std::size_t size)
+      : m_data{data}, m_size{size}, m_position{0}, m_failed{false} {}
+
+  auto failed() const -> bool { return m_failed; }
+
+  template <typename T> void read(T &value) {
+    static_assert(std::is_trivially_copyable_v<T>);
+    copy(&value, sizeof(value));
+  }
+
+  template <typename T> void read(std::vector<T> &vector) {
+    static_assert(std::is_trivially_copyable_v<T>);
+    const auto size = read_size(sizeof(T));
+    vector.resize(size);
+    copy(vector.data(), size * sizeof(T));
+  }
+
+  void read(std::string &string) {
+    string.resize(read_size(1));
+    copy(string.data(), string.size());
+  }
+
+  void read(math::Box &box) {
+    std::uint8_t valid = 0;
+    glm::vec3 min{};
+    glm::vec3 max{};
+    read(valid);
+    read(min);
+    read(max);
+    box = valid != 0 ? math::Box{min, max} : math::Box{};
+  }
+
+private:
+  const std::uint8_t *m_data;
+  std::size_t m_size;
+  std::size_t m_position;
+  bool m_failed;
+
+  void copy(void *destination, std::size_t size) {
+    if (m_failed || size > m_size - m_position) {
+      m_failed = true;
+      return;
+    }
+
+    std::memcpy(destination, m_data + m_position, size);
+    m_position += size;
+  }
+
+  // Checks size against remaining bytes to not allocate garbage.
+  auto read_size(std::size_t element_size) -> std::size_t {
+    std::uint64_t size = 0;
+    read(size);
+
+    if (m_failed || size > (m_size - m_position) / element_size) {
+      m_failed = true;
+      return 0;
+    }
+
+    return size;
+  }
+};
+
+} // namespace
+
+MapCache::MapCache(const std::filesystem::path &root_path,
+                   unreal::LoadProfile profile)
+    : m_root_path{root_path}, m_profile{profile} {}
+
+auto MapCache::load(const std::string &name) const -> std::optional<Map> {
+  const auto path = cache_path(name);
+
+  if (!std::filesystem::exists(path)) {
+    return {};
+  }
+
+  const utils::MappedFile file{path};
+
+  if (!file.is_open()) {
+    return {};
+  }
+
+  CacheReader reader{file.data(), file.size()};
+
+  std::uint32_t magic = 0;
+  std::uint32_t version = 0;
+  std::uint32_t profile = 0;
+  reader.read(magic);
+  reader.read(version);
+  reader.read(profile);
+
+  if (reader.failed() || magic != MAGIC || version != VERSION ||
+      profile != static_cast<std::uint32_t>(m_profile)) {
+    return {};
+  }
+
+  // Dependencies.
+  std::uint64_t dependency_count = 0;
+  reader.read(dependency_count);
+
+  for (std::uint64_t i = 0; i < dependency_count && !reader.failed(); ++i) {
+    Dependency cached{};
+    reader.read(cached.path);
+    reader.read(cached.size);
+    reader.read(cached.time);
+
+    const auto current = stat_dependency(cached.path);
+
+    if (!current.has_value() || current->size != cached.size ||
+        current->time != cached.time) {
+
+      utils::Log(utils::LOG_INFO, "App")
+          << "Map cache is outdated: " << name << std::endl;
+      return {};
+    }
+  }
+
+  Map map{};
+  map.name = name;
+  reader.read(map.position);
+  reader.read(map.bounding_box);
+
+  // Terrain heightmap.
+  std::uint8_t has_heightmap = 0;
+  reader.read(has_heightmap);
+
+  if (has_heightmap != 0) {
+    map.heightmap = std::make_shared<geodata::Heightmap>();
+    reader.read(map.heightmap->width);
+    reader.read(map.heightmap->height);
+    reader.read(map.heightmap->origin);
+    reader.read(map.heightmap->scale);
+    reader.read(map.heightmap->heights);
+    reader.read(map.heightmap->normals);
+    reader.read(map.heightmap->quads);
+  }
+
+  // Meshes.
+  std::uint64_t mesh_count = 0;
+  reader.read(mesh_count);
+
+  std::vector<std::shared_ptr<EntityMesh>> meshes;
+
+  for (std::uint64_t i = 0; i < mesh_count && !reader.failed(); ++i) {
+    auto mesh = std::make_shared<EntityMesh>();
+    reader.read(mesh->vertices);
+    reader.read(mesh->indices);
+    reader.read(mesh->instance_matrices);
+    reader.read(mesh->bounding_box);
+
+    std::uint64_t surface_count = 0;
+    reader.read(surface_count);
+
+    for (std::uint64_t j = 0; j < surface_count && !reader.failed(); ++j) {
+      Surface surface{};
+      std::uint64_t index_offset = 0;
+      std::uint64_t index_count = 0;
+      std::uint32_t texture_format = 0;
+      std::uint64_t texture_width = 0;
+      std::uint64_t texture_height = 0;
+
+      reader.read(surface.type);
+      reader.read(index_offset);
+      reader.read(index_count);
+      reader.read(surface.material.color);
+      reader.read(texture_format);
+      reader.read(texture_width);
+      reader.read(texture_height);
+
+      surface.index_offset = index_offset;
+      surface.index_count = index_count;
+      surface.material.texture.format =
+          static_cast<TextureFormat>(texture_format);
+      surface.material.texture.width = texture_width;
+      surface.material.texture.height = texture_height;
+      surface.material.texture.data = nullptr;
+
+      mesh->surfaces.push_back(surface);
+    }
+
+    meshes.push_back(std::move(mesh));
+  }
+
+  // Entities.
+  std::uint64_t entity_count = 0;
+  reader.read(entity_count);
+
+  for (std::uint64_t i = 0; i < entity_count && !reader.failed(); ++i) {
+    std::uint64_t mesh_index = 0;
+    reader.read(mesh_index);
+
+    if (mesh_index >= meshes.size()) {
+      return {};
+    }
+
+    Entity<EntityMesh> entity{meshes[mesh_index]};
+    std::uint8_t wireframe = 0;
+    reader.read(entity.position);
+    reader.read(entity.rotation);
+    reader.read(entity.scale);
+    reader.read(wireframe);
+    entity.wireframe = wireframe != 0;
+
+    map.entities.push_back(std::move(entity));
+  }
+
+  if (reader.failed()) {
+    utils::Log(utils::LOG_WARN, "App")
+        << "Map cache is broken: " << name << std::endl;
+    return {};
+  }
+
+  utils::Log(utils::LOG_INFO, "App")
+      << "Map loaded from cache: " << name << std::endl;
+
+  return map;
+}
+
+void MapCache::save(
+    const Map &map,
+    const std::vector<std::filesystem::path> &dependencies) const {
+
+  std::vector<Dependency> stats;
+
+  for (const auto &dependency : dependencies) {
+    const auto stat = stat_dependency(dependency);
+
+    if (!stat.has_value()) {
+      return;
+    }
+
+    stats.push_back(stat.value());
+  }
+
+  std::error_code error;
+  std::filesystem::create_directories(m_root_path, error);
+
+  const auto path = cache_path(map.name);
+  auto temporary_path = path;
+  temporary_path += ".tmp";
+
+  {
+    std::ofstream output{temporary_path, std::ios::binary};
+
+    if (!output) {
+      utils::Log(utils::LOG_WARN, "App")
+          << "Can't write map cache: " << temporary_path << std::endl;
+      return;
+    }
+
+    CacheWriter writer{output};
+    writer.write(MAGIC);
+    writer.write(VERSION);
+    writer.write(static_cast<std::uint32_t>(m_profile));
+
+    // Dependencies.
+    writer.write<std::uint64_t>(stats.size());
+
+    for (const auto &stat : stats) {
+      writer.write(stat.path);
+      writer.write(stat.size);
+      writer.write(stat.time);
+    }
+
+    writer.write(map.position);
+    writer.write(map.bounding_box);
+
+    // Terrain heightmap.
+    writer.write<std::uint8_t>(map.heightmap != nullptr);
+
+    if (map.heightmap != nullptr) {
+      writer.write(map.heightmap->width);
+      writer.write(map.heightmap->height);
+      writer.write(map.heightmap->origin);
+      writer.write(map.heightmap->scale);
+      writer.write(map.heightmap->heights);
+      writer.write(map.heightmap->normals);
+      writer.write(map.heightmap->quads);
+    }
+
+    // Meshes, shared between entities.
+    std::unordered_map<const EntityMesh *, std::uint64_t> mesh_indices;
+    std::vector<const EntityMesh *> meshes;
+
+    for (const auto &entity : map.entities) {
+      if (mesh_indices.try_emplace(entity.mesh.get(), meshes.size()).second) {
+        meshes.push_back(entity.mesh.get());
+      }
+    }
+
+    writer.write<std::uint64_t>(meshes.size());
+
+    for (const auto *mesh : meshes) {
+      writer.write(mesh->vertices);
+      writer.write(mesh->indices);
+      writer.write(mesh->instance_matrices);
+      writer.write(mesh->bounding_box);
+
+      writer.write<std::uint64_t>(mesh->surfaces.size());
+
+      // Textures aren't cached, map meshes don't use them.
+      for (const auto &surface : mesh->surfaces) {
+        writer.write(surface.type);
+        writer.write<std::uint64_t>(surface.index_offset);
+        writer.write<std::uint64_t>(surface.index_count);
+        writer.write(surface.material.color);
+        writer.write<std::uint32_t>(surface.material.texture.format);
+        writer.write<std::uint64_t>(surface.material.texture.width);
+        writer.write<std::uint64_t>(surface.material.texture.height);
+      }
+    }
+
+    // Entities.
+    writer.write<std::uint64_t>(map.entities.size());
+
+    for (const auto &entity : map.entities) {
+      writer.write(mesh_indices[entity.mesh.get()]);
+      writer.write(entity.position);
+      writer.write(entity.rotation);
+      writer.write(entity.scale);
+      writer.write<std::uint8_t>(entity.wireframe);
+    }
+  }
+
+  std::filesystem::rename(temporary_path, path, error);
+
+  if (error) {
+    utils::Log(utils::LOG_WARN, "App")
+        << "Can't write map cache: " << path << std::endl;
+  }
+}
+
+auto MapCache::cache_path(const std::string &name) const
+    -> std::filesystem::path {
+
+  // Collision only maps have no UVs, so they can't be used for rendering.
+  const auto suffix =
+      m_profile == unreal::LoadProfile::CollisionOnly ? ".collision" : "";
+
+  return m_root_path / (name + suffix + ".cache");
+}
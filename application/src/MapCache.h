@@ -0,0 +1,35 @@
+#pragma once
+
+#include "Map.h"
+
+#include <unreal/LoadProfile.h>
+
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <vector>
+
+// Binary cache of converted maps. Cache is valid while converter version,
+// load profile and size and modification time of every source package are
+// the same. Maps of each profile are cached in separate files.
+class MapCache {
+public:
+  explicit MapCache(const std::filesystem::path &root_path,
+                    unreal::LoadProfile profile = unreal::LoadProfile::Full);
+
+  auto load(const std::string &name) const -> std::optional<Map>;
+  void save(const Map &map,
+            const std::vector<std::filesystem::path> &dependencies) const;
+
+private:
+  static constexpr std::uint32_t MAGIC = 0x434d324c; // L2MC
+
+  // Increment when UnrealLoader output changes.
+  static constexpr std::uint32_t VERSION = 5;
+
+  std::filesystem::path m_root_path;
+  unreal::LoadProfile m_profile;
+
+  auto cache_path(const std::string &name) const -> std::filesystem::path;
+};
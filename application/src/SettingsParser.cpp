@@ -0,0 +1,116 @@
+#include "pch.h"
+
+#include "SettingsParser.h"
+
+static auto trim(const std::string &string) -> std::string {
+  const auto *whitespace = " \t\r\n";
+  const auto begin = string.find_first_not_of(whitespace);
+
+  if (begin == std::string::npos) {
+    return {};
+  }
+
+  const auto end = string.find_last_not_of(whitespace);
+  return string.substr(begin, end - begin + 1);
+}
+
+auto SettingsParser::parse_option(const std::string &key,
+                                  const std::string &value,
+                                  geodata::BuilderSettings &settings) const
+    -> bool {
+
+  // Accept both dashes and underscores.
+  auto name = key;
+  std::replace(name.begin(), name.end(), '-', '_');
+
+  const std::unordered_map<std::string, float *> float_options = {
+      {"cell_size", &settings.cell_size},
+      {"cell_height", &settings.cell_height},
+      {"walkable_height", &settings.walkable_height},
+      {"wall_angle", &settings.wall_angle},
+      {"walkable_angle", &settings.walkable_angle},
+      {"min_walkable_climb", &settings.min_walkable_climb},
+      {"max_walkable_climb", &settings.max_walkable_climb},
+  };
+
+  const std::unordered_map<std::string, int *> int_options = {
+      {"tile_size", &settings.tile_size},
+      {"thread_count", &settings.thread_count},
+  };
+
+  // Whole value must be a number, std::stof and std::stoi accept a prefix.
+  std::size_t end = 0;
+
+  try {
+    if (const auto option = float_options.find(name);
+        option != float_options.end()) {
+      const auto number = std::stof(value, &end);
+
+      if (end != value.size()) {
+        throw std::invalid_argument{value};
+      }
+
+      *option->second = number;
+      return true;
+    }
+
+    if (const auto option = int_options.find(name);
+        option != int_options.end()) {
+      const auto number = std::stoi(value, &end);
+
+      if (end != value.size()) {
+        throw std::invalid_argument{value};
+      }
+
+      *option->second = number;
+      return true;
+    }
+  } catch (const std::logic_error &) {
+    utils::Log(utils::LOG_ERROR, "App")
+        << "Invalid value of setting " << key << ": " << value << std::endl;
+    return false;
+  }
+
+  utils::Log(utils::LOG_ERROR, "App") << "Unknown setting: " << key << std::endl;
+  return false;
+}
+
+auto SettingsParser::parse_file(const std::filesystem::path &path,
+                                geodata::BuilderSettings &settings) const
+    -> bool {
+
+  std::ifstream input{path};
+
+  if (!input) {
+    utils::Log(utils::LOG_ERROR, "App")
+        << "Can't open settings file: " << path << std::endl;
+    return false;
+  }
+
+  std::string line;
+
+  while (std::getline(input, line)) {
+    // Skip comments and empty lines.
+    line = trim(line.substr(0, line.find('#')));
+
+    if (line.empty()) {
+      continue;
+    }
+
+    const auto separator = line.find('=');
+
+    if (separator == std::string::npos) {
+      utils::Log(utils::LOG_ERROR, "App")
+          << "Invalid line in settings file " << path << ": " << line
+          << std::endl;
+      return false;
+    }
+
+    if (!parse_option(trim(line.substr(0, separator)),
+                      trim(line.substr(separator + 1)), settings)) {
+      return false;
+    }
+  }
+
+  return true;
+}
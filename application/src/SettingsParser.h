@@ -0,0 +1,17 @@
+#pragma once
+
+#include <geodata/BuilderSettings.h>
+
+#include <filesystem>
+#include <string>
+
+// Reads geodata builder settings from `key = value` config files and
+// `--key=value` command line options.
+class SettingsParser {
+public:
+  auto parse_option(const std::string &key, const std::string &value,
+                    geodata::BuilderSettings &settings) const -> bool;
+
+  auto parse_file(const std::filesystem::path &path,
+                  geodata::BuilderSettings &settings) const -> bool;
+};
@@ -1,6 +1,26 @@
 #pragma once
 
 #include <functional>
+#include <string>
+#include <vector>
+
+enum GeodataBuildState {
+  GEODATA_BUILD_QUEUED,
+  GEODATA_BUILD_BUILDING,
+  GEODATA_BUILD_EXPORTING,
+  GEODATA_BUILD_DONE,
+  GEODATA_BUILD_CANCELLED,
+  GEODATA_BUILD_FAILED,
+};
+
+// Maps built at once, each build is limited in memory.
+static constexpr auto DEFAULT_CONCURRENT_BUILDS = 2;
+
+struct GeodataBuildStatus {
+  std::string map_name;
+  GeodataBuildState state;
+  float progress;
+};
 
 struct UIContext {
   struct {
@@ -24,7 +44,13 @@ struct UIContext {
     float walkable_angle;
     float min_walkable_climb;
     float max_walkable_climb;
+    int tile_size;
+    int thread_count;
+    int concurrent_builds;
     std::function<void()> build_handler;
+    std::function<void()> cancel_handler;
     bool export_;
+    bool building;
+    std::vector<GeodataBuildStatus> builds;
   } geodata;
 };
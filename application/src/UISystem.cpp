@@ -88,35 +88,85 @@ void UISystem::geodata_window() const {
                     &m_ui_context.geodata.min_walkable_climb);
   ImGui::InputFloat("Max Walkable Climb",
                     &m_ui_context.geodata.max_walkable_climb);
-
-  if (ImGui::Button("Reset")) {
-    reset_geodata_settings();
-    ASSERT(m_ui_context.geodata.build_handler, "App",
-           "Geodata build handler must be defined");
-    m_ui_context.geodata.build_handler();
-  }
-
-  ImGui::SameLine();
-
-  if (ImGui::Button("Build")) {
-    ASSERT(m_ui_context.geodata.build_handler, "App",
-           "Geodata build handler must be defined");
-    m_ui_context.geodata.build_handler();
+  ImGui::InputInt("Tile Size", &m_ui_context.geodata.tile_size, 0);
+  ImGui::InputInt("Threads", &m_ui_context.geodata.thread_count, 0);
+  ImGui::InputInt("Concurrent Maps", &m_ui_context.geodata.concurrent_builds,
+                  0);
+
+  if (m_ui_context.geodata.building) {
+    if (ImGui::Button("Cancel")) {
+      ASSERT(m_ui_context.geodata.cancel_handler, "App",
+             "Geodata cancel handler must be defined");
+      m_ui_context.geodata.cancel_handler();
+    }
+  } else {
+    if (ImGui::Button("Reset")) {
+      reset_geodata_settings();
+      ASSERT(m_ui_context.geodata.build_handler, "App",
+             "Geodata build handler must be defined");
+      m_ui_context.geodata.build_handler();
+    }
+
+    ImGui::SameLine();
+
+    if (ImGui::Button("Build")) {
+      ASSERT(m_ui_context.geodata.build_handler, "App",
+             "Geodata build handler must be defined");
+      m_ui_context.geodata.build_handler();
+    }
   }
 
   ImGui::SameLine();
 
   ImGui::Checkbox("Export", &m_ui_context.geodata.export_);
 
+  // Build progress.
+  for (const auto &build : m_ui_context.geodata.builds) {
+    ImGui::ProgressBar(build.progress, ImVec2{100.0f, 0.0f},
+                       build_state_name(build.state));
+    ImGui::SameLine();
+    ImGui::Text("%s", build.map_name.c_str());
+  }
+
   ImGui::End();
 }
 
 void UISystem::reset_geodata_settings() const {
-  m_ui_context.geodata.cell_size = 8.0f;
-  m_ui_context.geodata.cell_height = 1.0f;
-  m_ui_context.geodata.walkable_height = 46.0f;
-  m_ui_context.geodata.wall_angle = 87.5f;
-  m_ui_context.geodata.walkable_angle = 45.0f;
-  m_ui_context.geodata.min_walkable_climb = 10.0f;
-  m_ui_context.geodata.max_walkable_climb = 16.0f;
+  const geodata::BuilderSettings settings{};
+  m_ui_context.geodata.cell_size = settings.cell_size;
+  m_ui_context.geodata.cell_height = settings.cell_height;
+  m_ui_context.geodata.walkable_height = settings.walkable_height;
+  m_ui_context.geodata.wall_angle = settings.wall_angle;
+  m_ui_context.geodata.walkable_angle = settings.walkable_angle;
+  m_ui_context.geodata.min_walkable_climb = settings.min_walkable_climb;
+  m_ui_context.geodata.max_walkable_climb = settings.max_walkable_climb;
+  m_ui_context.geodata.tile_size = settings.tile_size;
+  m_ui_context.geodata.thread_count = settings.thread_count;
+  m_ui_context.geodata.concurrent_builds = DEFAULT_CONCURRENT_BUILDS;
+}
+
+auto UISystem::build_state_name(GeodataBuildState state) const -> const char * {
+  switch (state) {
+  case GEODATA_BUILD_QUEUED: {
+    return "Queued";
+  }
+  case GEODATA_BUILD_BUILDING: {
+    return "Building";
+  }
+  case GEODATA_BUILD_EXPORTING: {
+    return "Exporting";
+  }
+  case GEODATA_BUILD_DONE: {
+    return "Done";
+  }
+  case GEODATA_BUILD_CANCELLED: {
+    return "Cancelled";
+  }
+  case GEODATA_BUILD_FAILED: {
+    return "Failed";
+  }
+  default: {
+    return "Unknown";
+  }
+  }
 }
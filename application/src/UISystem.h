@@ -24,4 +24,6 @@ private:
   void geodata_window() const;
 
   void reset_geodata_settings() const;
+
+  auto build_state_name(GeodataBuildState state) const -> const char *;
 };
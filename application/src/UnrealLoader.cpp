@@ -3,14 +3,54 @@
 #include "Conversion.h"
 #include "UnrealLoader.h"
 
-UnrealLoader::UnrealLoader(const std::filesystem::path &root_path)
+namespace {
+
+// Resolves references of independent objects in parallel, so that the
+// referenced objects are deserialized concurrently.
+template <typename T, typename Resolve>
+void resolve_in_parallel(const unreal::PackageLoader &package_loader,
+                         const std::vector<std::shared_ptr<T>> &objects,
+                         Resolve resolve) {
+
+  // Packages loaded by workers are kept until the caller is done.
+  auto *caller_pin = package_loader.current_pin();
+
+  utils::ThreadPool pool;
+  std::atomic_size_t next_object = 0;
+  std::vector<std::future<void>> futures;
+
+  for (std::size_t i = 0; i < pool.thread_count(); ++i) {
+    futures.push_back(pool.submit([&] {
+      const auto pin = package_loader.pin(caller_pin);
+
+      for (auto j = next_object++; j < objects.size(); j = next_object++) {
+        resolve(*objects[j]);
+      }
+    }));
+  }
+
+  for (auto &future : futures) {
+    future.get();
+  }
+}
+
+} // namespace
+
+UnrealLoader::UnrealLoader(const std::filesystem::path &root_path,
+                           unreal::LoadProfile profile)
     : m_package_loader{root_path,
                        {unreal::SearchConfig{"MAPS", "unr"},
                         unreal::SearchConfig{"StaticMeshes", "usx"},
                         unreal::SearchConfig{"Textures", "utx"},
-                        unreal::SearchConfig{"SysTextures", "utx"}}} {}
+                        unreal::SearchConfig{"SysTextures", "utx"}},
+                       profile, PACKAGE_CACHE_BUDGET} {}
+
+auto UnrealLoader::load_map(
+    const std::string &name,
+    std::vector<std::filesystem::path> &dependencies) const -> Map {
+  // Packages can be evicted only after the map is converted.
+  const auto pin = m_package_loader.pin();
 
-auto UnrealLoader::load_map(const std::string &name) const -> Map {
   Map map{};
 
   const auto optional_package = m_package_loader.load_package(name);
@@ -23,6 +63,7 @@ auto UnrealLoader::load_map(const std::string &name) const -> Map {
 
   // Terrain.
   const auto terrain = load_terrain(package);
+  dependencies = map_dependencies(name, package, *terrain);
 
   map.position = to_vec3(terrain->position());
   const auto scale = to_vec3(terrain->scale());
@@ -35,6 +76,8 @@ auto UnrealLoader::load_map(const std::string &name) const -> Map {
     map.entities.insert(map.entities.end(),
                         std::make_move_iterator(terrain_entities.begin()),
                         std::make_move_iterator(terrain_entities.end()));
+
+    map.heightmap = load_terrain_heightmap(*terrain);
   }
 
   // Mesh actors.
@@ -58,15 +101,63 @@ auto UnrealLoader::load_map(const std::string &name) const -> Map {
   return map;
 }
 
-auto UnrealLoader::load_map_package(int x, int y) const
-    -> std::optional<unreal::Package> {
+auto UnrealLoader::preload_maps(const std::vector<std::string> &names) const
+    -> std::size_t {
+
+  // Decrypted package is about the size of its file.
+  std::vector<std::string> preloaded_names;
+  std::uintmax_t preload_size = 0;
 
+  for (const auto &name : names) {
+    const auto path = m_package_loader.package_path(name);
+    std::error_code error;
+    auto size = path.empty() ? 0 : std::filesystem::file_size(path, error);
+
+    if (error) {
+      size = 0;
+    }
+
+    if (!preloaded_names.empty() && preload_size + size > PRELOAD_BUDGET) {
+      break;
+    }
+
+    preload_size += size;
+    preloaded_names.push_back(name);
+  }
+
+  // Imports are prefetched when the map is loaded.
+  m_package_loader.load_packages(preloaded_names, false);
+  return preloaded_names.size();
+}
+
+auto UnrealLoader::map_dependencies(
+    const std::string &name, const unreal::Package &package,
+    const unreal::TerrainInfoActor &terrain) const
+    -> std::vector<std::filesystem::path> {
+
+  auto names = package.import_package_names();
+  names.push_back(name);
+  names.push_back(map_package_name(terrain.map_x, terrain.map_y + 1));
+  names.push_back(map_package_name(terrain.map_x + 1, terrain.map_y));
+  names.push_back(map_package_name(terrain.map_x + 1, terrain.map_y + 1));
+
+  std::vector<std::filesystem::path> paths;
+
+  for (const auto &package_name : names) {
+    auto path = m_package_loader.package_path(package_name);
+
+    if (!path.empty()) {
+      paths.push_back(std::move(path));
+    }
+  }
+
+  return paths;
+}
+
+auto UnrealLoader::map_package_name(int x, int y) const -> std::string {
   std::stringstream stream;
   stream << x << "_" << y;
-  const auto package_name = stream.str();
-
-  const auto package = m_package_loader.load_package(package_name);
-  return package;
+  return stream.str();
 }
 
 auto UnrealLoader::load_terrain(const unreal::Package &package) const
@@ -86,22 +177,79 @@ auto UnrealLoader::load_terrain(const unreal::Package &package) const
   return terrain;
 }
 
-auto UnrealLoader::load_side_terrain(int x, int y) const
-    -> std::shared_ptr<unreal::TerrainInfoActor> {
+auto UnrealLoader::load_terrain_edge(const unreal::TerrainInfoActor &terrain,
+                                     int x, int y) const
+    -> std::shared_ptr<const TerrainEdge> {
+
+  const auto package_name = map_package_name(x, y);
+  auto cached_edge = m_terrain_edge_cache.find(package_name);
 
-  const auto package = load_map_package(x, y);
+  if (cached_edge == m_terrain_edge_cache.end()) {
+    cached_edge = m_terrain_edge_cache
+                      .emplace(package_name, read_terrain_edge(package_name))
+                      .first;
+  }
+
+  const auto &edge = cached_edge->second;
+
+  if (edge == nullptr || edge->width != terrain.terrain_map->u_size ||
+      edge->height != terrain.terrain_map->v_size) {
+    return nullptr;
+  }
+
+  return edge;
+}
+
+auto UnrealLoader::read_terrain_edge(const std::string &package_name) const
+    -> std::shared_ptr<const TerrainEdge> {
+
+  // Side objects aren't converted, so imported packages aren't needed.
+  const auto package = m_package_loader.load_package(package_name, false);
 
   if (!package.has_value()) {
     return nullptr;
   }
 
-  auto terrain = load_terrain(package.value());
+  std::vector<std::shared_ptr<unreal::TerrainInfoActor>> terrains;
+  package->load_objects("TerrainInfo", terrains);
 
-  if (terrain->broken_scale()) {
+  if (terrains.empty() || terrains[0]->broken_scale() ||
+      terrains[0]->terrain_map->mips.empty()) {
     return nullptr;
   }
 
-  return terrain;
+  const auto &terrain = *terrains[0];
+  const auto width = terrain.terrain_map->u_size;
+  const auto height = terrain.terrain_map->v_size;
+
+  // Only border samples are copied, not the whole heightmap.
+  const auto heights = terrain.terrain_map->mip_data(0);
+
+  if (width <= 0 || height <= 0 ||
+      heights.size() < static_cast<std::size_t>(width) * height *
+                           sizeof(std::uint16_t)) {
+    return nullptr;
+  }
+
+  auto edge = std::make_shared<TerrainEdge>();
+  edge->width = width;
+  edge->height = height;
+  edge->position_z = terrain.position().z;
+  edge->scale_z = terrain.scale().z;
+
+  edge->north_row.resize(width);
+  std::memcpy(edge->north_row.data(), heights.data(),
+              width * sizeof(std::uint16_t));
+
+  edge->west_column.resize(height);
+
+  for (auto y = 0; y < height; ++y) {
+    std::memcpy(&edge->west_column[y],
+                heights.data() + y * width * sizeof(std::uint16_t),
+                sizeof(std::uint16_t));
+  }
+
+  return edge;
 }
 
 auto UnrealLoader::load_terrain_entities(
@@ -110,8 +258,6 @@ auto UnrealLoader::load_terrain_entities(
 
   std::vector<Entity<EntityMesh>> entities;
 
-  const auto &mips = terrain.terrain_map->mips;
-
   const auto width = terrain.terrain_map->u_size;
   const auto height = terrain.terrain_map->v_size;
 
@@ -127,7 +273,7 @@ auto UnrealLoader::load_terrain_entities(
     const auto position = to_vec3(terrain.position());
     const auto scale = to_vec3(terrain.scale());
 
-    const auto *heightmap = mips[0].as<std::uint16_t>();
+    const auto heightmap = terrain.terrain_map->load_mip<std::uint16_t>(0);
 
     // Bounding box.
     const auto bounding_box = terrain.bounding_box();
@@ -182,19 +328,18 @@ auto UnrealLoader::load_terrain_entities(
 
   {
     // South.
-    const auto south_terrain =
-        load_side_terrain(terrain.map_x, terrain.map_y + 1);
+    const auto south_edge =
+        load_terrain_edge(terrain, terrain.map_x, terrain.map_y + 1);
 
-    if (south_terrain != nullptr) {
+    if (south_edge != nullptr) {
       const glm::vec3 position = {terrain.position().x, terrain.position().y,
-                                  south_terrain->position().z};
+                                  south_edge->position_z};
       const glm::vec3 scale = {terrain.scale().x, terrain.scale().y,
-                               south_terrain->scale().z};
+                               south_edge->scale_z};
 
       const auto y = height;
 
-      const auto *heightmap =
-          south_terrain->terrain_map->mips[0].as<std::uint16_t>();
+      const auto &heightmap = south_edge->north_row;
 
       for (auto x = 0; x < width; ++x) {
         mesh->vertices.push_back(
@@ -223,27 +368,26 @@ auto UnrealLoader::load_terrain_entities(
 
   {
     // East.
-    const auto east_terrain =
-        load_side_terrain(terrain.map_x + 1, terrain.map_y);
+    const auto east_edge =
+        load_terrain_edge(terrain, terrain.map_x + 1, terrain.map_y);
 
-    if (east_terrain != nullptr) {
+    if (east_edge != nullptr) {
       const glm::vec3 position = {terrain.position().x, terrain.position().y,
-                                  east_terrain->position().z};
+                                  east_edge->position_z};
       const glm::vec3 scale = {terrain.scale().x, terrain.scale().y,
-                               east_terrain->scale().z};
+                               east_edge->scale_z};
 
       const auto x = width;
 
-      const auto *heightmap =
-          east_terrain->terrain_map->mips[0].as<std::uint16_t>();
+      const auto &heightmap = east_edge->west_column;
 
       for (auto y = 0; y < height; ++y) {
         mesh->vertices.push_back(
-            {glm::vec3{x, y, heightmap[y * width]} * scale + position,
+            {glm::vec3{x, y, heightmap[y]} * scale + position,
              {0.0f, 0.0f, 0.0f},
              {x, y}});
 
-        heights[y * full_width + x] = heightmap[y * width];
+        heights[y * full_width + x] = heightmap[y];
 
         // First part of quad.
         if (y != height - 1) {
@@ -264,20 +408,19 @@ auto UnrealLoader::load_terrain_entities(
 
   {
     // Southeast.
-    const auto southeast_terrain =
-        load_side_terrain(terrain.map_x + 1, terrain.map_y + 1);
+    const auto southeast_edge =
+        load_terrain_edge(terrain, terrain.map_x + 1, terrain.map_y + 1);
 
-    if (southeast_terrain != nullptr) {
+    if (southeast_edge != nullptr) {
       const glm::vec3 position = {terrain.position().x, terrain.position().y,
-                                  southeast_terrain->position().z};
+                                  southeast_edge->position_z};
       const glm::vec3 scale = {terrain.scale().x, terrain.scale().y,
-                               southeast_terrain->scale().z};
+                               southeast_edge->scale_z};
 
       const auto x = width;
       const auto y = height;
 
-      const auto *heightmap =
-          southeast_terrain->terrain_map->mips[0].as<std::uint16_t>();
+      const auto &heightmap = southeast_edge->north_row;
 
       mesh->vertices.push_back(
           {glm::vec3{x, y, heightmap[0]} * scale + position,
@@ -302,16 +445,7 @@ auto UnrealLoader::load_terrain_entities(
     // Normals.
     for (auto y = 0; y < full_height; ++y) {
       for (auto x = 0; x < full_width; ++x) {
-        const float z = heights[y * full_width + x];
-
-        auto top = y > 0 ? heights[(y - 1) * full_width + x] : z;
-        auto bottom = y < height ? heights[(y + 1) * full_width + x] : z;
-        auto left = x > 0 ? heights[y * full_width + (x - 1)] : z;
-        auto right = x < width ? heights[y * full_width + (x + 1)] : z;
-
-        const auto normal = glm::normalize(
-            glm::vec3{(left - right) / (full_width * 2.0f),
-                      (top - bottom) / (full_height * 2.0f), 4.0f});
+        const auto normal = terrain_normal(heights, width, height, x, y);
 
         if (x < width && y <= height) {
           mesh->vertices[y * width + x].normal = normal;
@@ -347,6 +481,149 @@ auto UnrealLoader::load_terrain_entities(
   return entities;
 }
 
+auto UnrealLoader::load_terrain_heightmap(
+    const unreal::TerrainInfoActor &terrain) const
+    -> std::shared_ptr<geodata::Heightmap> {
+
+  const auto width = terrain.terrain_map->u_size;
+  const auto height = terrain.terrain_map->v_size;
+
+  const auto position = to_vec3(terrain.position());
+  const auto scale = to_vec3(terrain.scale());
+
+  const auto heights = terrain.terrain_map->load_mip<std::uint16_t>(0);
+
+  // Same grid as terrain mesh, including edges with side terrains.
+  auto heightmap = std::make_shared<geodata::Heightmap>();
+  heightmap->width = width + 1;
+  heightmap->height = height + 1;
+  heightmap->origin = {position.x, position.y};
+  heightmap->scale = {scale.x, scale.y};
+  heightmap->heights.resize(heightmap->width * heightmap->height);
+  heightmap->quads.resize(width * height);
+
+  const auto full_width = heightmap->width;
+  const auto full_height = heightmap->height;
+
+  // Raw heights for normals, the same as terrain mesh has.
+  std::vector<std::uint16_t> raw_heights(full_width * full_height);
+
+  for (auto y = 0; y < height; ++y) {
+    for (auto x = 0; x < width; ++x) {
+      heightmap->heights[y * full_width + x] =
+          static_cast<float>(heights[y * width + x]) * scale.z + position.z;
+      raw_heights[y * full_width + x] = heights[y * width + x];
+    }
+  }
+
+  for (auto y = 0; y < height - 1; ++y) {
+    for (auto x = 0; x < width - 1; ++x) {
+      if (!terrain.quad_visibility_bitmap[x + y * width]) {
+        continue;
+      }
+
+      heightmap->quads[x + y * width] =
+          geodata::QUAD_VISIBLE |
+          (terrain.edge_turn_bitmap[x + y * width] ? geodata::QUAD_TURNED : 0);
+    }
+  }
+
+  // South.
+  const auto south_edge =
+      load_terrain_edge(terrain, terrain.map_x, terrain.map_y + 1);
+
+  if (south_edge != nullptr) {
+    const auto &south_heights = south_edge->north_row;
+    const auto south_position = south_edge->position_z;
+    const auto south_scale = south_edge->scale_z;
+
+    for (auto x = 0; x < width; ++x) {
+      heightmap->heights[height * full_width + x] =
+          static_cast<float>(south_heights[x]) * south_scale + south_position;
+      raw_heights[height * full_width + x] = south_heights[x];
+
+      if (x != width - 1) {
+        heightmap->quads[x + (height - 1) * width] =
+            geodata::QUAD_VISIBLE | geodata::QUAD_TURNED |
+            geodata::QUAD_SOUTH_EDGE;
+      }
+    }
+  }
+
+  // East.
+  const auto east_edge =
+      load_terrain_edge(terrain, terrain.map_x + 1, terrain.map_y);
+
+  if (east_edge != nullptr) {
+    const auto &east_heights = east_edge->west_column;
+    const auto east_position = east_edge->position_z;
+    const auto east_scale = east_edge->scale_z;
+
+    for (auto y = 0; y < height; ++y) {
+      heightmap->heights[y * full_width + width] =
+          static_cast<float>(east_heights[y]) * east_scale + east_position;
+      raw_heights[y * full_width + width] = east_heights[y];
+
+      if (y != height - 1) {
+        heightmap->quads[(width - 1) + y * width] =
+            geodata::QUAD_VISIBLE | geodata::QUAD_TURNED |
+            geodata::QUAD_EAST_EDGE;
+      }
+    }
+  }
+
+  // Southeast, the corner quad uses south and east edge vertices too.
+  const auto southeast_edge =
+      load_terrain_edge(terrain, terrain.map_x + 1, terrain.map_y + 1);
+
+  if (southeast_edge != nullptr && south_edge != nullptr &&
+      east_edge != nullptr) {
+
+    const auto southeast_height = southeast_edge->north_row[0];
+
+    heightmap->heights[height * full_width + width] =
+        static_cast<float>(southeast_height) * southeast_edge->scale_z +
+        southeast_edge->position_z;
+    raw_heights[height * full_width + width] = southeast_height;
+
+    heightmap->quads[(width - 1) + (height - 1) * width] =
+        geodata::QUAD_VISIBLE | geodata::QUAD_SOUTH_EDGE |
+        geodata::QUAD_EAST_EDGE;
+  }
+
+  // Normals.
+  heightmap->normals.reserve(full_width * full_height);
+
+  for (auto y = 0; y < full_height; ++y) {
+    for (auto x = 0; x < full_width; ++x) {
+      heightmap->normals.push_back(
+          terrain_normal(raw_heights, width, height, x, y));
+    }
+  }
+
+  return heightmap;
+}
+
+auto UnrealLoader::terrain_normal(const std::vector<std::uint16_t> &heights,
+                                  int width, int height, int x, int y) const
+    -> glm::vec3 {
+
+  // Size with edges.
+  const auto full_width = width + 1;
+  const auto full_height = height + 1;
+
+  const float z = heights[y * full_width + x];
+
+  auto top = y > 0 ? heights[(y - 1) * full_width + x] : z;
+  auto bottom = y < height ? heights[(y + 1) * full_width + x] : z;
+  auto left = x > 0 ? heights[y * full_width + (x - 1)] : z;
+  auto right = x < width ? heights[y * full_width + (x + 1)] : z;
+
+  return glm::normalize(glm::vec3{(left - right) / (full_width * 2.0f),
+                                  (top - bottom) / (full_height * 2.0f),
+                                  4.0f});
+}
+
 auto UnrealLoader::load_mesh_actor_entities(
     const unreal::Package &package) const -> std::vector<Entity<EntityMesh>> {
 
@@ -357,6 +634,13 @@ auto UnrealLoader::load_mesh_actor_entities(
   package.load_objects("MovableStaticMeshActor", mesh_actors);
   package.load_objects("L2MovableStaticMeshActor", mesh_actors);
 
+  resolve_in_parallel(m_package_loader, mesh_actors,
+                      [](const unreal::StaticMeshActor &mesh_actor) {
+                        if (!mesh_actor.delete_me && !mesh_actor.hidden) {
+                          mesh_actor.static_mesh.preload();
+                        }
+                      });
+
   for (const auto &mesh_actor : mesh_actors) {
     if (mesh_actor->delete_me || mesh_actor->hidden) {
       continue;
@@ -389,16 +673,21 @@ auto UnrealLoader::load_mesh_actor_entities(
       // Bounding box.
       mesh->bounding_box = bounding_box;
 
-      ASSERT(!unreal_mesh->uv_stream.empty(), "App",
-             "Surface doesn't have texture coordinates");
-      auto uvs = unreal_mesh->uv_stream[0].uvs.begin();
+      // Texture coordinates aren't loaded for collision only.
+      const auto *uvs = !unreal_mesh->uv_stream.empty()
+                            ? unreal_mesh->uv_stream[0].uvs.data()
+                            : nullptr;
 
       // Vertices.
       for (const auto &vertex : unreal_mesh->vertex_stream.vertices) {
-        mesh->vertices.push_back({to_vec3(vertex.location),
-                                  to_vec3(vertex.normal),
-                                  {uvs->u, uvs->v}});
-        ++uvs;
+        mesh->vertices.push_back(
+            {to_vec3(vertex.location),
+             to_vec3(vertex.normal),
+             uvs != nullptr ? glm::vec2{uvs->u, uvs->v} : glm::vec2{}});
+
+        if (uvs != nullptr) {
+          ++uvs;
+        }
       }
 
       // Surfaces.
@@ -490,6 +779,10 @@ auto UnrealLoader::load_volume_entities(const unreal::Package &package,
   package.load_objects("BlockingVolume", volumes);
   //  package.load_objects("WaterVolume", volumes);
 
+  resolve_in_parallel(
+      m_package_loader, volumes,
+      [](const unreal::VolumeActor &volume) { volume.brush.preload(); });
+
   for (const auto &volume : volumes) {
     if (!volume->brush) {
       continue;
@@ -517,62 +810,109 @@ auto UnrealLoader::load_model_entity(const unreal::Model &model,
     return {};
   }
 
-  const auto mesh = std::make_shared<EntityMesh>();
+  // Points are shared between nodes, so each one is checked once.
+  std::vector<std::uint8_t> outside_points;
 
-  for (const auto &node : model.nodes) {
-    if ((node.flags & unreal::NF_Passable) != 0) {
-      continue;
-    }
+  if (check_bounds) {
+    outside_points.reserve(model.points.size());
 
-    if (check_bounds && check_bsp_node_bounds(model, node, map_bounding_box)) {
-      continue;
+    for (const auto &point : model.points) {
+      outside_points.push_back(!map_bounding_box.contains(to_vec3(point)));
     }
+  }
 
-    const auto &surface = model.surfaces[node.surface_index];
+  // Triangle corners as welding keys: point and surface normal. Back faces of
+  // two-sided polygons use front vertices, as they always did.
+  const auto corner_key = [&model](const unreal::BSPNode &node, int vertex,
+                                   std::int32_t normal_index) -> std::uint64_t {
+    const std::uint32_t point_index =
+        model.vertices[node.vertex_pool_index + vertex].vertex_index;
 
-    if ((surface.polygon_flags & unreal::PF_Passable) != 0) {
-      continue;
-    }
+    return static_cast<std::uint64_t>(point_index) << 32 |
+           static_cast<std::uint32_t>(normal_index);
+  };
 
-    const auto &normal = model.vectors[surface.normal_index];
+  const auto triangulate_nodes = [&](std::size_t begin, std::size_t end,
+                                     std::vector<std::uint64_t> &corners) {
+    for (auto i = begin; i < end; ++i) {
+      const auto &node = model.nodes[i];
 
-    const auto vertex_start = mesh->vertices.size();
+      if ((node.flags & unreal::NF_Passable) != 0) {
+        continue;
+      }
 
-    // Vertices.
-    for (auto i = 0; i < node.vertex_count; ++i) {
-      const auto &position =
-          model.points[model.vertices[node.vertex_pool_index + i].vertex_index];
+      if (check_bounds && check_bsp_node_bounds(model, node, outside_points)) {
+        continue;
+      }
 
-      mesh->bounding_box += to_vec3(position);
+      const auto &surface = model.surfaces[node.surface_index];
 
-      mesh->vertices.push_back(
-          {to_vec3(position), to_vec3(normal), {0.0f, 0.0f}});
-    }
+      if ((surface.polygon_flags & unreal::PF_Passable) != 0) {
+        continue;
+      }
 
-    if ((surface.polygon_flags & unreal::PF_TwoSided) != 0) {
-      for (auto i = 0; i < node.vertex_count; ++i) {
-        const auto &position =
-            model.points[model.vertices[node.vertex_pool_index + i]
-                             .vertex_index];
+      for (auto j = 2; j < node.vertex_count; ++j) {
+        corners.push_back(corner_key(node, 0, surface.normal_index));
+        corners.push_back(corner_key(node, j - 1, surface.normal_index));
+        corners.push_back(corner_key(node, j, surface.normal_index));
+      }
 
-        mesh->vertices.push_back(
-            {to_vec3(position), {normal.x, normal.y, -normal.z}, {0.0f, 0.0f}});
+      if ((surface.polygon_flags & unreal::PF_TwoSided) != 0) {
+        for (auto j = 2; j < node.vertex_count; ++j) {
+          corners.push_back(corner_key(node, 0, surface.normal_index));
+          corners.push_back(corner_key(node, j, surface.normal_index));
+          corners.push_back(corner_key(node, j - 1, surface.normal_index));
+        }
       }
     }
+  };
+
+  // Nodes are triangulated in parallel chunks, then welded in chunk order to
+  // keep output stable.
+  const auto chunk_count = std::clamp<std::size_t>(
+      model.nodes.size() / MIN_BSP_CHUNK_SIZE, 1,
+      std::max(std::thread::hardware_concurrency(), 1u));
+  const auto chunk_size = (model.nodes.size() + chunk_count - 1) / chunk_count;
+
+  std::vector<std::vector<std::uint64_t>> chunk_corners(chunk_count);
+
+  if (chunk_count == 1) {
+    triangulate_nodes(0, model.nodes.size(), chunk_corners[0]);
+  } else {
+    utils::ThreadPool pool{chunk_count};
+    std::vector<std::future<void>> futures;
+
+    for (std::size_t i = 0; i < chunk_count; ++i) {
+      futures.push_back(pool.submit([&, i] {
+        triangulate_nodes(i * chunk_size,
+                          std::min((i + 1) * chunk_size, model.nodes.size()),
+                          chunk_corners[i]);
+      }));
+    }
 
-    // Indices.
-    for (auto i = 2; i < node.vertex_count; ++i) {
-      mesh->indices.push_back(vertex_start);
-      mesh->indices.push_back(vertex_start + i - 1);
-      mesh->indices.push_back(vertex_start + i);
+    for (auto &future : futures) {
+      future.get();
     }
+  }
+
+  const auto mesh = std::make_shared<EntityMesh>();
+  std::unordered_map<std::uint64_t, std::uint32_t> vertex_indices;
+
+  for (const auto &corners : chunk_corners) {
+    for (const auto corner : corners) {
+      const auto [vertex_index, inserted] = vertex_indices.try_emplace(
+          corner, static_cast<std::uint32_t>(mesh->vertices.size()));
 
-    if ((surface.polygon_flags & unreal::PF_TwoSided) != 0) {
-      for (auto i = 2; i < node.vertex_count; ++i) {
-        mesh->indices.push_back(vertex_start);
-        mesh->indices.push_back(vertex_start + i);
-        mesh->indices.push_back(vertex_start + i - 1);
+      if (inserted) {
+        const auto &position = model.points[corner >> 32];
+        const auto &normal = model.vectors[corner & 0xffffffff];
+
+        mesh->bounding_box += to_vec3(position);
+        mesh->vertices.push_back(
+            {to_vec3(position), to_vec3(normal), {0.0f, 0.0f}});
       }
+
+      mesh->indices.push_back(vertex_index->second);
     }
   }
 
@@ -666,13 +1006,11 @@ auto UnrealLoader::bounding_box_mesh(std::uint64_t type,
 
 auto UnrealLoader::check_bsp_node_bounds(
     const unreal::Model &model, const unreal::BSPNode &node,
-    const math::Box &map_bounding_box) const -> bool {
+    const std::vector<std::uint8_t> &outside_points) const -> bool {
 
   for (auto i = 0; i < node.vertex_count; ++i) {
-    const auto &position =
-        model.points[model.vertices[node.vertex_pool_index + i].vertex_index];
-
-    if (!map_bounding_box.contains(to_vec3(position))) {
+    if (outside_points[model.vertices[node.vertex_pool_index + i]
+                           .vertex_index] != 0) {
       return true;
     }
   }
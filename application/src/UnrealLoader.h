@@ -13,6 +13,7 @@
 
 #include <math/Box.h>
 
+#include <cstddef>
 #include <filesystem>
 #include <memory>
 #include <optional>
@@ -22,11 +23,42 @@
 
 class UnrealLoader {
 public:
-  explicit UnrealLoader(const std::filesystem::path &root_path);
+  explicit UnrealLoader(
+      const std::filesystem::path &root_path,
+      unreal::LoadProfile profile = unreal::LoadProfile::Full);
 
-  auto load_map(const std::string &name) const -> Map;
+  // Package files used to convert the map are returned in `dependencies`:
+  // map package, side terrains and imported packages.
+  auto load_map(const std::string &name,
+                std::vector<std::filesystem::path> &dependencies) const -> Map;
+
+  // Loads leading map packages in parallel, so load_map finds them in cache.
+  // Only packages fitting the preload budget are loaded, returns their count.
+  auto preload_maps(const std::vector<std::string> &names) const
+      -> std::size_t;
 
 private:
+  // Heights of region borders with north and west neighbours, enough to
+  // stitch terrain seams.
+  struct TerrainEdge {
+    int width;
+    int height;
+    float position_z;
+    float scale_z;
+    std::vector<std::uint16_t> north_row;   // y = 0
+    std::vector<std::uint16_t> west_column; // x = 0
+  };
+
+  // Package data kept in memory between maps.
+  static constexpr std::size_t PACKAGE_CACHE_BUDGET = 1024 * 1024 * 1024;
+
+  // Part of the budget for preloaded maps, the rest is for the converted map
+  // and its imports.
+  static constexpr std::size_t PRELOAD_BUDGET = PACKAGE_CACHE_BUDGET / 4;
+
+  // Smaller BSPs are converted in one thread.
+  static constexpr std::size_t MIN_BSP_CHUNK_SIZE = 4096;
+
   unreal::PackageLoader m_package_loader;
 
   mutable std::unordered_map<std::string, std::shared_ptr<EntityMesh>>
@@ -34,14 +66,28 @@ private:
   mutable std::unordered_map<std::string, std::shared_ptr<EntityMesh>>
       m_bb_mesh_cache;
 
-  auto load_map_package(int x, int y) const -> std::optional<unreal::Package>;
+  // Null for regions without usable terrain.
+  mutable std::unordered_map<std::string, std::shared_ptr<const TerrainEdge>>
+      m_terrain_edge_cache;
+
+  auto map_package_name(int x, int y) const -> std::string;
+  auto map_dependencies(const std::string &name,
+                        const unreal::Package &package,
+                        const unreal::TerrainInfoActor &terrain) const
+      -> std::vector<std::filesystem::path>;
   auto load_terrain(const unreal::Package &package) const
       -> std::shared_ptr<unreal::TerrainInfoActor>;
-  auto load_side_terrain(int x, int y) const
-      -> std::shared_ptr<unreal::TerrainInfoActor>;
-
+  // Side terrain edge matching terrain dimensions, null if there is none.
+  auto load_terrain_edge(const unreal::TerrainInfoActor &terrain, int x,
+                         int y) const -> std::shared_ptr<const TerrainEdge>;
+  auto read_terrain_edge(const std::string &package_name) const
+      -> std::shared_ptr<const TerrainEdge>;
   auto load_terrain_entities(const unreal::TerrainInfoActor &terrain) const
       -> std::vector<Entity<EntityMesh>>;
+  auto load_terrain_heightmap(const unreal::TerrainInfoActor &terrain) const
+      -> std::shared_ptr<geodata::Heightmap>;
+  auto terrain_normal(const std::vector<std::uint16_t> &heights, int width,
+                      int height, int x, int y) const -> glm::vec3;
   auto load_mesh_actor_entities(const unreal::Package &package) const
       -> std::vector<Entity<EntityMesh>>;
   auto load_bsp_entities(const unreal::Package &package,
@@ -65,7 +111,9 @@ private:
   auto bounding_box_mesh(std::uint64_t type, const math::Box &box) const
       -> std::shared_ptr<EntityMesh>;
 
+  // True if any node vertex is outside of the map.
   auto check_bsp_node_bounds(const unreal::Model &model,
                              const unreal::BSPNode &node,
-                             const math::Box &map_bounding_box) const -> bool;
+                             const std::vector<std::uint8_t> &outside_points)
+      const -> bool;
 };
@@ -35,7 +35,9 @@
 
 #include <utils/Assert.h>
 #include <utils/Log.h>
+#include <utils/MappedFile.h>
 #include <utils/NonCopyable.h>
+#include <utils/ThreadPool.h>
 
 #include <math/Box.h>
 #include <math/Transformation.h>
@@ -51,16 +53,26 @@
 
 #include <llvm/Endian.h>
 
+#include <algorithm>
+#include <atomic>
+#include <cctype>
 #include <cstddef>
+#include <cstdint>
+#include <cstring>
 #include <filesystem>
 #include <fstream>
+#include <future>
 #include <functional>
 #include <iostream>
 #include <iterator>
 #include <memory>
 #include <mutex>
 #include <numbers>
+#include <optional>
+#include <regex>
 #include <sstream>
 #include <thread>
+#include <type_traits>
+#include <unordered_map>
 #include <utility>
 #include <vector>
@@ -0,0 +1,109 @@
+#include "TriangleAreas.h"
+
+#include <utils/Log.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <numeric>
+#include <random>
+#include <vector>
+
+// Compares mark_triangles kernels on random geometry: speed and areas.
+auto main(int argc, char **argv) -> int {
+  const auto triangle_count =
+      argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 2'000'000ull;
+  const auto runs = 5;
+
+  std::mt19937 random{42};
+  std::uniform_real_distribution<float> coordinate{-16384.0f, 16384.0f};
+  std::uniform_real_distribution<float> edge{-64.0f, 64.0f};
+  std::uniform_real_distribution<float> slope{-24.0f, 24.0f};
+
+  // Vertices are shuffled, so positions are gathered like in real meshes.
+  std::vector<int> order(triangle_count * 3);
+  std::iota(order.begin(), order.end(), 0);
+  std::shuffle(order.begin(), order.end(), random);
+
+  std::vector<float> vertices(triangle_count * 9);
+  std::vector<int> triangles(triangle_count * 3);
+
+  for (std::size_t i = 0; i < triangle_count; ++i) {
+    // Planes of any slope and facing, some triangles are degenerate.
+    const auto x = coordinate(random);
+    const auto y = coordinate(random);
+    const auto z = coordinate(random);
+    const auto slope_x = slope(random);
+    const auto slope_z = slope(random);
+    const auto up = random() % 2 == 0;
+    const auto degenerate = i % 64 == 0;
+
+    float dx[3] = {0.0f, edge(random), edge(random)};
+    float dz[3] = {0.0f, edge(random), edge(random)};
+
+    if (degenerate) {
+      dx[2] = dx[1];
+      dz[2] = dz[1];
+    }
+
+    for (auto j = 0; j < 3; ++j) {
+      const auto vertex = order[i * 3 + j];
+      const auto side = j == 0 ? 0 : (up ? j : 3 - j);
+
+      vertices[vertex * 3 + 0] = x + dx[side];
+      vertices[vertex * 3 + 1] = y + slope_x * dx[side] + slope_z * dz[side];
+      vertices[vertex * 3 + 2] = z + dz[side];
+      triangles[i * 3 + j] = vertex;
+    }
+  }
+
+  const auto walkable_angle = 45.0f;
+  const auto wall_angle = 87.5f;
+
+  std::vector<unsigned char> expected(triangle_count);
+  geodata::mark_triangles(walkable_angle, wall_angle, vertices.data(),
+                          triangles.data(), triangle_count, expected.data(),
+                          geodata::TriangleKernel::Scalar);
+
+  const auto best = geodata::best_triangle_kernel();
+  auto identical = true;
+
+  for (const auto kernel :
+       {geodata::TriangleKernel::Scalar, geodata::TriangleKernel::SSE41,
+        geodata::TriangleKernel::AVX2}) {
+
+    if (kernel > best) {
+      break;
+    }
+
+    std::vector<unsigned char> areas(triangle_count);
+    auto best_time = std::chrono::duration<double, std::milli>::max();
+
+    for (auto run = 0; run < runs; ++run) {
+      const auto start = std::chrono::steady_clock::now();
+      geodata::mark_triangles(walkable_angle, wall_angle, vertices.data(),
+                              triangles.data(), triangle_count, areas.data(),
+                              kernel);
+      const auto end = std::chrono::steady_clock::now();
+
+      best_time = std::min<std::chrono::duration<double, std::milli>>(
+          best_time, end - start);
+    }
+
+    const auto mismatches = triangle_count -
+                            std::inner_product(areas.begin(), areas.end(),
+                                               expected.begin(), 0ull,
+                                               std::plus<>{},
+                                               std::equal_to<>{});
+
+    identical = identical && mismatches == 0;
+
+    utils::Log(utils::LOG_INFO, "Benchmark")
+        << geodata::triangle_kernel_name(kernel) << ": " << best_time.count()
+        << " ms for " << triangle_count << " triangles, " << mismatches
+        << " mismatches" << std::endl;
+  }
+
+  return identical ? EXIT_SUCCESS : EXIT_FAILURE;
+}
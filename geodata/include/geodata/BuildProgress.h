@@ -0,0 +1,14 @@
+#pragma once
+
+#include <atomic>
+
+namespace geodata {
+
+// Observed and cancelled from other threads while map is being built.
+struct BuildProgress {
+  std::atomic_int built_tiles = 0;
+  std::atomic_int total_tiles = 0;
+  std::atomic_bool cancelled = false;
+};
+
+} // namespace geodata
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "BuildProgress.h"
 #include "BuilderSettings.h"
 #include "Geodata.h"
 #include "Map.h"
@@ -8,7 +9,9 @@ namespace geodata {
 
 class Builder {
 public:
-  auto build(const Map &map, const BuilderSettings &settings) const -> Geodata;
+  // Returns empty geodata if build is cancelled.
+  auto build(const Map &map, const BuilderSettings &settings,
+             BuildProgress *progress = nullptr) const -> Geodata;
 };
 
 } // namespace geodata
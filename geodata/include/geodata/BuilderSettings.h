@@ -3,13 +3,15 @@
 namespace geodata {
 
 struct BuilderSettings {
-  float cell_size;
-  float cell_height;
-  float walkable_height;
-  float wall_angle;
-  float walkable_angle;
-  float min_walkable_climb;
-  float max_walkable_climb;
+  float cell_size = 8.0f;
+  float cell_height = 1.0f;
+  float walkable_height = 46.0f;
+  float wall_angle = 87.5f;
+  float walkable_angle = 45.0f;
+  float min_walkable_climb = 10.0f;
+  float max_walkable_climb = 16.0f;
+  int tile_size = 128; // In geodata cells, 0 builds the whole map as one tile.
+  int thread_count = 0; // 0 uses hardware concurrency.
 };
 
 } // namespace geodata
@@ -2,19 +2,65 @@
 
 #include <glm/glm.hpp>
 
+#include <cstddef>
 #include <cstdint>
 #include <memory>
+#include <type_traits>
 #include <vector>
 
 namespace geodata {
 
-struct Vertex {
-  glm::vec3 position;
-  glm::vec3 normal;
+// Positions and normals of vertices owned by someone else, e.g. by a render
+// mesh, so vertex data is shared instead of copied. Vertex type must have
+// `position` and `normal` members.
+class VertexBuffer {
+public:
+  VertexBuffer()
+      : m_data{nullptr}, m_size{0}, m_stride{0}, m_position_offset{0},
+        m_normal_offset{0} {}
+
+  template <typename T>
+  explicit VertexBuffer(std::shared_ptr<const std::vector<T>> vertices)
+      : m_owner{vertices},
+        m_data{reinterpret_cast<const std::uint8_t *>(vertices->data())},
+        m_size{vertices->size()}, m_stride{sizeof(T)},
+        m_position_offset{offsetof(T, position)},
+        m_normal_offset{offsetof(T, normal)} {
+
+    static_assert(std::is_standard_layout_v<T>);
+    static_assert(std::is_same_v<decltype(T::position), glm::vec3>);
+    static_assert(std::is_same_v<decltype(T::normal), glm::vec3>);
+  }
+
+  auto size() const -> std::size_t { return m_size; }
+  auto empty() const -> bool { return m_size == 0; }
+
+  auto position(std::size_t index) const -> const glm::vec3 & {
+    return attribute(index, m_position_offset);
+  }
+
+  auto normal(std::size_t index) const -> const glm::vec3 & {
+    return attribute(index, m_normal_offset);
+  }
+
+private:
+  std::shared_ptr<const void> m_owner;
+  const std::uint8_t *m_data;
+  std::size_t m_size;
+  std::size_t m_stride;
+  std::size_t m_position_offset;
+  std::size_t m_normal_offset;
+
+  auto attribute(std::size_t index, std::size_t offset) const
+      -> const glm::vec3 & {
+
+    return *reinterpret_cast<const glm::vec3 *>(m_data + index * m_stride +
+                                                offset);
+  }
 };
 
 struct Mesh {
-  std::vector<Vertex> vertices;
+  VertexBuffer vertices;
   std::vector<unsigned int> indices;
   std::vector<glm::mat4> instance_matrices;
 };
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <vector>
+
+namespace geodata {
+
+enum QuadFlags {
+  QUAD_VISIBLE = 0x1,
+
+  // Quad is split by (0, 1) - (1, 0) diagonal instead of (0, 0) - (1, 1).
+  QUAD_TURNED = 0x2,
+
+  // Edge quads are connected to neighbour terrain and have own triangle order.
+  QUAD_SOUTH_EDGE = 0x4,
+  QUAD_EAST_EDGE = 0x8,
+};
+
+// Regular terrain grid in world space (Z-up). Vertex (x, y) is at
+// (origin.x + x * scale.x, origin.y + y * scale.y, heights[x + y * width]).
+struct Heightmap {
+  int width;
+  int height;
+  glm::vec2 origin;
+  glm::vec2 scale;
+  std::vector<float> heights;
+
+  // Vertex normals, triangle facing down against them is rasterized as null
+  // area, the same way as mesh triangles with wrong winding.
+  std::vector<glm::vec3> normals;
+
+  // (width - 1) * (height - 1) quads.
+  std::vector<std::uint8_t> quads;
+};
+
+} // namespace geodata
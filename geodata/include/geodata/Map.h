@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Entity.h"
+#include "Heightmap.h"
 
 #include <utils/NonCopyable.h>
 
@@ -9,12 +10,35 @@
 #include <glm/glm.hpp>
 
 #include <cstdint>
+#include <memory>
 #include <string>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
 namespace geodata {
 
+// Consecutive mesh triangles with local bounds, lets builder skip parts of
+// big meshes (BSP) outside of tile.
+struct MeshChunk {
+  std::size_t index_offset;
+  std::size_t index_count;
+  math::Box bounding_box;
+};
+
+struct MapMesh {
+  std::shared_ptr<const Mesh> mesh;
+  std::vector<MeshChunk> chunks;
+  math::Box bounding_box;
+};
+
+// Mesh placement, transformed to world space by builder.
+struct MeshInstance {
+  std::size_t mesh; // Index in Map::meshes.
+  glm::mat4 model_matrix; // Recast space (Y-up).
+  math::Box bounding_box; // World space, Recast axes.
+};
+
 class Map : public utils::NonCopyable {
 public:
   explicit Map(const std::string &name, const math::Box &bounding_box)
@@ -22,23 +46,34 @@ public:
 
   Map(Map &&other) noexcept
       : m_name{std::move(other.m_name)},
-        m_vertices{std::move(other.m_vertices)}, m_indices{std::move(
-                                                     other.m_indices)},
+        m_meshes{std::move(other.m_meshes)},
+        m_mesh_indices{std::move(other.m_mesh_indices)},
+        m_instances{std::move(other.m_instances)},
+        m_heightmap{std::move(other.m_heightmap)},
         m_bounding_box{std::move(other.m_bounding_box)} {}
 
   void add(const Entity &entity);
 
+  // Terrain is rasterized from heightmap instead of triangles.
+  void set_heightmap(std::shared_ptr<const Heightmap> heightmap);
+
   auto name() const -> const std::string &;
 
-  auto vertices() const -> const std::vector<glm::vec3> &;
-  auto indices() const -> const std::vector<unsigned int> &;
+  // Unique meshes, shared between instances.
+  auto meshes() const -> const std::vector<MapMesh> &;
+
+  // In the order of added entities.
+  auto instances() const -> const std::vector<MeshInstance> &;
+  auto heightmap() const -> const Heightmap *;
 
   auto bounding_box() const -> const math::Box &;
 
 private:
   std::string m_name;
-  std::vector<glm::vec3> m_vertices;
-  std::vector<unsigned int> m_indices;
+  std::vector<MapMesh> m_meshes;
+  std::unordered_map<const Mesh *, std::size_t> m_mesh_indices;
+  std::vector<MeshInstance> m_instances;
+  std::shared_ptr<const Heightmap> m_heightmap;
   math::Box m_bounding_box;
 };
 
@@ -8,112 +8,425 @@ namespace geodata {
 
 static constexpr auto destination_cell_size = 16.0f;
 
-auto Builder::build(const Map &map, const BuilderSettings &settings) const
-    -> Geodata {
+// Tiles are built with a border of neighbour cells. The outer border cell can
+// get clamped triangles of the cut off geometry, the inner one is exact and is
+// needed for NSWE of the tile edge cells.
+static constexpr auto tile_border_size = 2;
 
-  // Configuration.
-  const auto source_cell_size = settings.cell_size;
-  const auto cell_height = settings.cell_height;
-  const auto walkable_height =
-      static_cast<int>(std::ceil(settings.walkable_height / cell_height));
-  const auto wall_angle = settings.wall_angle;
-  const auto walkable_angle = settings.walkable_angle;
-  const auto min_walkable_climb =
-      static_cast<int>(std::floor(settings.min_walkable_climb / cell_height));
-  const auto max_walkable_climb =
-      static_cast<int>(std::floor(settings.max_walkable_climb / cell_height));
+struct BuildConfig {
+  float source_cell_size;
+  float cell_height;
+  int walkable_height;
+  int min_walkable_climb;
+  int max_walkable_climb;
+  int depth;
+  float walkable_angle;
+  float wall_angle;
+  int x_ratio;
+  int y_ratio;
+  std::size_t nswe_thread_count;
+  float bb_min[3];
+  float bb_max[3];
+};
 
-  // Flip bounding box for Recast (Y <-> Z).
-  const auto *source_bb_min = glm::value_ptr(map.bounding_box().min());
-  const auto *source_bb_max = glm::value_ptr(map.bounding_box().max());
-  float bb_min[3] = {source_bb_min[0], source_bb_min[2], source_bb_min[1]};
-  float bb_max[3] = {source_bb_max[0], source_bb_max[2], source_bb_max[1]};
+struct Tile {
+  // Geodata cells owned by the tile.
+  int x;
+  int y;
+  int width;
+  int height;
 
-  // Calculate grid size.
-  auto source_width = 0;
-  auto source_height = 0;
-  rcCalcGridSize(static_cast<float *>(bb_min), static_cast<float *>(bb_max),
-                 source_cell_size, &source_width, &source_height);
+  // Geodata cells rasterized for the tile, including border.
+  int border_x;
+  int border_y;
+  int border_width;
+  int border_height;
 
-  // Destination grid size.
-  auto destination_width = 0;
-  auto destination_height = 0;
-  rcCalcGridSize(static_cast<float *>(bb_min), static_cast<float *>(bb_max),
-                 destination_cell_size, &destination_width,
-                 &destination_height);
+  float bb_min[3];
+  float bb_max[3];
+};
+
+// World space triangles of the tile, only alive while the tile is built.
+struct TileGeometry {
+  std::vector<glm::vec3> vertices;
+  std::vector<int> triangles;
+  std::vector<unsigned char> areas;
+};
+
+// Cells of the owned tile area, one vector per row.
+using TileRows = std::vector<std::vector<Cell>>;
+
+// Instance and chunk bounds are transformed corners, so they can be off by
+// rounding from transformed vertices.
+static constexpr auto bounds_margin = 1.0f;
+
+// Same overlap test as Recast does against the heightfield bounds, geometry
+// outside of them can't produce spans.
+static auto overlaps_bounds(const float *bb_min, const float *bb_max,
+                            const glm::vec3 &min, const glm::vec3 &max,
+                            float margin) -> bool {
+
+  return min.x <= bb_max[0] + margin && max.x >= bb_min[0] - margin &&
+         min.y <= bb_max[1] + margin && max.y >= bb_min[1] - margin &&
+         min.z <= bb_max[2] + margin && max.z >= bb_min[2] - margin;
+}
+
+// Transforms mesh instances overlapping the tile to world space. Triangles keep
+// the order of the map (span merging depends on it).
+static auto
+make_tile_geometry(const BuildConfig &config, const Map &map,
+                   const std::vector<const MeshInstance *> &instances,
+                   const Tile &tile) -> TileGeometry {
+
+  const auto overlaps = [&tile](const glm::vec3 &min, const glm::vec3 &max,
+                                float margin) {
+    return overlaps_bounds(tile.bb_min, tile.bb_max, min, max, margin);
+  };
+
+  TileGeometry geometry;
+
+  // World space normals of the tile vertices.
+  std::vector<glm::vec3> normals;
+
+  // Tile vertex of the mesh vertex, transformed on first use.
+  std::vector<int> tile_vertices;
+
+  for (const auto *instance_pointer : instances) {
+    const auto &instance = *instance_pointer;
+
+    if (!overlaps(instance.bounding_box.min(), instance.bounding_box.max(),
+                  bounds_margin)) {
+      continue;
+    }
+
+    const auto &map_mesh = map.meshes()[instance.mesh];
+    const auto &mesh = *map_mesh.mesh;
+    const auto normal_matrix =
+        glm::inverseTranspose(glm::mat3{instance.model_matrix});
+
+    tile_vertices.assign(mesh.vertices.size(), -1);
+
+    const auto tile_vertex = [&](unsigned int index) {
+      auto &tile_index = tile_vertices[index];
+
+      if (tile_index < 0) {
+        tile_index = static_cast<int>(geometry.vertices.size());
+        geometry.vertices.emplace_back(
+            instance.model_matrix *
+            glm::vec4{mesh.vertices.position(index), 1.0f});
+        normals.emplace_back(
+            glm::normalize(normal_matrix * mesh.vertices.normal(index)));
+      }
+
+      return tile_index;
+    };
+
+    for (const auto &chunk : map_mesh.chunks) {
+      const math::Box chunk_box{chunk.bounding_box, instance.model_matrix};
+
+      if (!overlaps(chunk_box.min(), chunk_box.max(), bounds_margin)) {
+        continue;
+      }
+
+      for (auto i = chunk.index_offset;
+           i < chunk.index_offset + chunk.index_count; i += 3) {
+
+        const auto index0 = tile_vertex(mesh.indices[i + 0]);
+        const auto index1 = tile_vertex(mesh.indices[i + 1]);
+        const auto index2 = tile_vertex(mesh.indices[i + 2]);
+
+        const auto &v0 = geometry.vertices[index0];
+        const auto &v1 = geometry.vertices[index1];
+        const auto &v2 = geometry.vertices[index2];
+
+        // Downward faces are kept, their null spans still block.
+        const auto min = glm::min(v0, glm::min(v1, v2));
+        const auto max = glm::max(v0, glm::max(v1, v2));
+
+        if (!overlaps(min, max, 0.0f)) {
+          continue;
+        }
+
+        // Try to fix winding.
+        const auto average_normal = glm::normalize(
+            (normals[index0] + normals[index1] + normals[index2]) / 3.0f);
+        const auto face_normal = glm::triangleNormal(v2, v1, v0);
+
+        if (glm::dot(average_normal, face_normal) >= 0.0f) {
+          geometry.triangles.insert(geometry.triangles.end(),
+                                    {index2, index1, index0});
+        } else {
+          geometry.triangles.insert(geometry.triangles.end(),
+                                    {index0, index1, index2});
+        }
+      }
+    }
+  }
+
+  geometry.areas.resize(geometry.triangles.size() / 3);
+
+  if (!geometry.areas.empty()) {
+    mark_triangles(config.walkable_angle, config.wall_angle,
+                   glm::value_ptr(geometry.vertices.front()),
+                   geometry.triangles.data(), geometry.areas.size(),
+                   geometry.areas.data());
+  }
+
+  return geometry;
+}
+
+static auto build_tile(const BuildConfig &config, const Heightmap *heightmap,
+                       const TileGeometry &geometry, const Tile &tile)
+    -> TileRows {
 
   rcContext context{};
 
   // Create source heightfield.
   auto *source_hf = rcAllocHeightfield();
-  rcCreateHeightfield(&context, *source_hf, source_width, source_height,
-                      static_cast<float *>(bb_min),
-                      static_cast<float *>(bb_max), source_cell_size,
-                      cell_height);
+  rcCreateHeightfield(
+      &context, *source_hf, tile.border_width * config.x_ratio,
+      tile.border_height * config.y_ratio, tile.bb_min, tile.bb_max,
+      config.source_cell_size, config.cell_height);
 
-  // Prepare geometry data.
-  const auto *vertices = glm::value_ptr(map.vertices().front());
-  const auto vertex_count = map.vertices().size();
-  const auto *triangles = reinterpret_cast<const int *>(map.indices().data());
-  const auto triangle_count = map.indices().size() / 3;
+  // Rasterize terrain first, as it goes first in the map geometry.
+  if (heightmap != nullptr) {
+    rasterize_heightmap(&context, *heightmap, config.walkable_angle,
+                        config.wall_angle, *source_hf);
+  }
 
   // Rasterize triangles.
-  std::vector<unsigned char> areas(triangle_count);
-  mark_triangles(walkable_angle, wall_angle, vertices, triangles,
-                 triangle_count, &areas.front());
-  rcRasterizeTriangles(&context, vertices, vertex_count, triangles,
-                       &areas.front(), triangle_count, *source_hf, 0);
+  if (!geometry.areas.empty()) {
+    rcRasterizeTriangles(&context, glm::value_ptr(geometry.vertices.front()),
+                         static_cast<int>(geometry.vertices.size()),
+                         &geometry.triangles.front(), &geometry.areas.front(),
+                         static_cast<int>(geometry.areas.size()), *source_hf,
+                         0);
+  }
 
   // Create destination heightfield.
   auto *destination_hf = rcAllocHeightfield();
-  rcCreateHeightfield(&context, *destination_hf, destination_width,
-                      destination_height, static_cast<float *>(bb_min),
-                      static_cast<float *>(bb_max), destination_cell_size,
-                      cell_height);
-  merge_heightfields(&context, *source_hf, *destination_hf, min_walkable_climb);
+  rcCreateHeightfield(&context, *destination_hf, tile.border_width,
+                      tile.border_height, tile.bb_min, tile.bb_max,
+                      destination_cell_size, config.cell_height);
+  merge_heightfields(&context, *source_hf, *destination_hf,
+                     config.min_walkable_climb);
   rcFreeHeightField(source_hf);
 
+  // Compact heightfield for the following passes.
+  auto chf = make_compact_heightfield(*destination_hf);
+  rcFreeHeightField(destination_hf);
+
   // Filter low height spans.
-  rcFilterWalkableLowHeightSpans(&context, walkable_height, *destination_hf);
+  filter_low_height_spans(chf, config.walkable_height);
 
   // Calculate NSWE.
-  calculate_nswe(*destination_hf, walkable_height, min_walkable_climb,
-                 max_walkable_climb);
+  link_neighbour_spans(chf, config.walkable_height, config.nswe_thread_count);
+  calculate_nswe(chf, config.min_walkable_climb, config.max_walkable_climb,
+                 config.nswe_thread_count);
 
   // Convert heightfield to geodata.
-  Geodata geodata;
+  TileRows rows(tile.height);
 
-  const auto depth = static_cast<int>((bb_max[2] - bb_min[2]) / cell_height);
+  for (auto y = 0; y < tile.height; ++y) {
+    const auto hf_y = tile.y - tile.border_y + y;
 
-  for (auto y = 0; y < destination_hf->height; ++y) {
-    for (auto x = 0; x < destination_hf->width; ++x) {
-      for (auto *span = destination_hf->spans[x + y * destination_hf->width];
-           span != nullptr; span = span->next) {
+    for (auto x = 0; x < tile.width; ++x) {
+      const auto hf_x = tile.x - tile.border_x + x;
+      const auto column = hf_x + hf_y * tile.border_width;
 
-        const auto area = static_cast<int>(span->area) & 0xf;
-        const auto nswe = static_cast<int>(span->area) >> 4;
+      for (auto i = chf.columns[column]; i < chf.columns[column + 1]; ++i) {
+        const auto &span = chf.spans[i];
 
-        if (area == RC_NULL_AREA) {
+        if (span.area == RC_NULL_AREA) {
           continue;
         }
 
-        const auto z = static_cast<int>(span->smax) - depth / 2 + 1;
+        const auto z = static_cast<int>(span.bottom) - config.depth / 2 + 1;
 
-        geodata.cells.push_back({
-            x,
-            y,
-            static_cast<int>(static_cast<float>(z) * cell_height) + 28,
+        rows[y].push_back({
+            tile.x + x,
+            tile.y + y,
+            static_cast<int>(static_cast<float>(z) * config.cell_height) + 28,
             BLOCK_MULTILAYER,
-            (nswe & DIRECTION_N) != 0,
-            (nswe & DIRECTION_W) != 0,
-            (nswe & DIRECTION_E) != 0,
-            (nswe & DIRECTION_S) != 0,
+            (span.nswe & DIRECTION_N) != 0,
+            (span.nswe & DIRECTION_W) != 0,
+            (span.nswe & DIRECTION_E) != 0,
+            (span.nswe & DIRECTION_S) != 0,
         });
       }
     }
   }
 
-  rcFreeHeightField(destination_hf);
+  return rows;
+}
+
+auto Builder::build(const Map &map, const BuilderSettings &settings,
+                    BuildProgress *progress) const -> Geodata {
+
+  // Configuration.
+  BuildConfig config{};
+  config.source_cell_size = settings.cell_size;
+  config.cell_height = settings.cell_height;
+  config.walkable_height =
+      static_cast<int>(std::ceil(settings.walkable_height / config.cell_height));
+  config.min_walkable_climb = static_cast<int>(
+      std::floor(settings.min_walkable_climb / config.cell_height));
+  config.max_walkable_climb = static_cast<int>(
+      std::floor(settings.max_walkable_climb / config.cell_height));
+  config.walkable_angle = settings.walkable_angle;
+  config.wall_angle = settings.wall_angle;
+
+  // Flip bounding box for Recast (Y <-> Z).
+  const auto *source_bb_min = glm::value_ptr(map.bounding_box().min());
+  const auto *source_bb_max = glm::value_ptr(map.bounding_box().max());
+  auto *bb_min = static_cast<float *>(config.bb_min);
+  auto *bb_max = static_cast<float *>(config.bb_max);
+  bb_min[0] = source_bb_min[0];
+  bb_min[1] = source_bb_min[2];
+  bb_min[2] = source_bb_min[1];
+  bb_max[0] = source_bb_max[0];
+  bb_max[1] = source_bb_max[2];
+  bb_max[2] = source_bb_max[1];
+
+  config.depth = static_cast<int>((bb_max[2] - bb_min[2]) / config.cell_height);
+
+  // Calculate grid size.
+  auto source_width = 0;
+  auto source_height = 0;
+  rcCalcGridSize(bb_min, bb_max, config.source_cell_size, &source_width,
+                 &source_height);
+
+  // Destination grid size.
+  auto destination_width = 0;
+  auto destination_height = 0;
+  rcCalcGridSize(bb_min, bb_max, destination_cell_size, &destination_width,
+                 &destination_height);
+
+  config.x_ratio = source_width / destination_width;
+  config.y_ratio = source_height / destination_height;
+
+  ASSERT(config.x_ratio > 0 && config.y_ratio > 0, "Geodata",
+         "Cell size must not exceed " << destination_cell_size);
+
+  const auto *heightmap = map.heightmap();
+
+  // Instances which can produce spans in any tile.
+  std::vector<const MeshInstance *> instances;
+
+  for (const auto &instance : map.instances()) {
+    if (overlaps_bounds(bb_min, bb_max, instance.bounding_box.min(),
+                        instance.bounding_box.max(), bounds_margin)) {
+
+      instances.push_back(&instance);
+    }
+  }
+
+  utils::Log(utils::LOG_INFO, "Geodata")
+      << "Instances in map bounds: " << instances.size() << " of "
+      << map.instances().size() << std::endl;
+
+  // Split map into tiles.
+  const auto tile_size = settings.tile_size > 0
+                             ? std::max(settings.tile_size, tile_border_size)
+                             : std::max(destination_width, destination_height);
+  const auto border_size = settings.tile_size > 0 ? tile_border_size : 0;
+  const auto tiles_x = (destination_width + tile_size - 1) / tile_size;
+  const auto tiles_y = (destination_height + tile_size - 1) / tile_size;
+
+  std::vector<Tile> tiles(tiles_x * tiles_y);
+
+  for (auto ty = 0; ty < tiles_y; ++ty) {
+    for (auto tx = 0; tx < tiles_x; ++tx) {
+      auto &tile = tiles[tx + ty * tiles_x];
+
+      tile.x = tx * tile_size;
+      tile.y = ty * tile_size;
+      tile.width = std::min(tile_size, destination_width - tile.x);
+      tile.height = std::min(tile_size, destination_height - tile.y);
+
+      tile.border_x = std::max(tile.x - border_size, 0);
+      tile.border_y = std::max(tile.y - border_size, 0);
+      tile.border_width =
+          std::min(tile.x + tile.width + border_size, destination_width) -
+          tile.border_x;
+      tile.border_height =
+          std::min(tile.y + tile.height + border_size, destination_height) -
+          tile.border_y;
+
+      // Tile grid must match the map grid, so offset it in source cells.
+      const auto source_x = tile.border_x * config.x_ratio;
+      const auto source_y = tile.border_y * config.y_ratio;
+
+      tile.bb_min[0] =
+          bb_min[0] + static_cast<float>(source_x) * config.source_cell_size;
+      tile.bb_min[1] = bb_min[1];
+      tile.bb_min[2] =
+          bb_min[2] + static_cast<float>(source_y) * config.source_cell_size;
+      tile.bb_max[0] = tile.bb_min[0] +
+                       static_cast<float>(tile.border_width * config.x_ratio) *
+                           config.source_cell_size;
+      tile.bb_max[1] = bb_max[1];
+      tile.bb_max[2] = tile.bb_min[2] +
+                       static_cast<float>(tile.border_height * config.y_ratio) *
+                           config.source_cell_size;
+    }
+  }
+
+  // Build tiles.
+  const auto cancelled = [progress] {
+    return progress != nullptr && progress->cancelled;
+  };
+
+  if (progress != nullptr) {
+    progress->total_tiles = static_cast<int>(tiles.size());
+  }
+
+  utils::ThreadPool pool{
+      static_cast<std::size_t>(std::max(settings.thread_count, 0))};
+  std::vector<std::future<TileRows>> futures;
+
+  // Single tile leaves the pool idle, so its NSWE rows are split instead.
+  config.nswe_thread_count = tiles.size() == 1 ? pool.thread_count() : 1;
+
+  for (const auto &tile : tiles) {
+    futures.push_back(pool.submit([&config, &map, &instances, heightmap,
+                                   &tile, &cancelled, progress] {
+      if (cancelled()) {
+        return TileRows(tile.height);
+      }
+
+      const auto geometry = make_tile_geometry(config, map, instances, tile);
+      auto rows = build_tile(config, heightmap, geometry, tile);
+
+      if (progress != nullptr) {
+        progress->built_tiles++;
+      }
+
+      return rows;
+    }));
+  }
+
+  // Stitch tiles in the single tile order (rows, then columns).
+  Geodata geodata;
+
+  for (auto ty = 0; ty < tiles_y; ++ty) {
+    std::vector<TileRows> row_tiles;
+
+    for (auto tx = 0; tx < tiles_x; ++tx) {
+      row_tiles.push_back(futures[tx + ty * tiles_x].get());
+    }
+
+    for (auto y = 0; y < tiles[ty * tiles_x].height; ++y) {
+      for (const auto &rows : row_tiles) {
+        geodata.cells.insert(geodata.cells.end(), rows[y].begin(),
+                             rows[y].end());
+      }
+    }
+  }
+
+  if (cancelled()) {
+    return Geodata{};
+  }
 
   return geodata;
 }
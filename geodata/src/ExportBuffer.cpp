@@ -14,25 +14,34 @@ static constexpr auto MAX_LAYERS = 128;
 
 ExportBuffer::ExportBuffer(const Geodata &geodata)
     : m_blocks{MAP_WIDTH_BLOCKS * MAP_HEIGHT_BLOCKS},
-      m_columns{MAP_WIDTH_CELLS * MAP_HEIGHT_CELLS}, m_cells{MAP_WIDTH_CELLS *
-                                                             MAP_HEIGHT_CELLS *
-                                                             MAX_LAYERS} {
+      m_offsets(MAP_WIDTH_CELLS * MAP_HEIGHT_CELLS + 1),
+      m_cells(geodata.cells.size()) {
 
+  // Count layers per column.
   for (const auto &cell : geodata.cells) {
     const auto column_index = cell.y + cell.x * MAP_WIDTH_CELLS;
     const auto block_index = cell.y / BLOCK_HEIGHT_CELLS +
                              cell.x / BLOCK_WIDTH_CELLS * MAP_WIDTH_BLOCKS;
 
-    auto &column = m_columns[column_index];
-    auto &block = m_blocks[block_index];
+    const auto layers = ++m_offsets[column_index + 1];
+    m_blocks[block_index].type = cell.type;
 
-    column.layers++;
-    block.type = cell.type;
+    ASSERT(layers < MAX_LAYERS - 1, "Geodata", // MAX_LAYERS - 1 is ok.
+           "Too many layers in column: " << cell.x << " " << cell.y);
+  }
 
-    m_cells[column_index * MAX_LAYERS + column.layers - 1] = &cell;
+  // Turn counts into offsets.
+  for (std::size_t i = 1; i < m_offsets.size(); ++i) {
+    m_offsets[i] += m_offsets[i - 1];
+  }
 
-    ASSERT(column.layers < MAX_LAYERS - 1, "Geodata", // MAX_LAYERS - 1 is ok.
-           "Too many layers in column: " << cell.x << " " << cell.y);
+  // Place cells, keeping their original order within a column.
+  std::vector<std::uint32_t> positions{m_offsets.begin(),
+                                       m_offsets.end() - 1};
+
+  for (const auto &cell : geodata.cells) {
+    const auto column_index = cell.y + cell.x * MAP_WIDTH_CELLS;
+    m_cells[positions[column_index]++] = cell;
   }
 }
 
@@ -41,20 +50,21 @@ auto ExportBuffer::block(int x, int y) -> Block & {
   return m_blocks[block_index];
 }
 
-auto ExportBuffer::column(int x, int y, int cx, int cy) const
-    -> const Column & {
-  const auto column_index = (y * BLOCK_HEIGHT_CELLS) + cy +
-                            ((x * BLOCK_WIDTH_CELLS) + cx) * MAP_WIDTH_CELLS;
-  return m_columns[column_index];
+auto ExportBuffer::column(int x, int y, int cx, int cy) const -> Column {
+  const auto index = column_index(x, y, cx, cy);
+  return {static_cast<std::uint8_t>(m_offsets[index + 1] - m_offsets[index])};
 }
 
 auto ExportBuffer::cell(int x, int y, int cx, int cy, int layer) const
     -> const Cell & {
 
-  const auto column_index = (y * BLOCK_HEIGHT_CELLS) + cy +
-                            ((x * BLOCK_WIDTH_CELLS) + cx) * MAP_WIDTH_CELLS;
-  const auto cell_index = column_index * MAX_LAYERS + layer;
-  return *m_cells[cell_index];
+  const auto index = column_index(x, y, cx, cy);
+  return m_cells[m_offsets[index] + layer];
+}
+
+auto ExportBuffer::column_index(int x, int y, int cx, int cy) const -> int {
+  return (y * BLOCK_HEIGHT_CELLS) + cy +
+         ((x * BLOCK_WIDTH_CELLS) + cx) * MAP_WIDTH_CELLS;
 }
 
 } // namespace geodata
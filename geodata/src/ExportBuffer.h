@@ -2,6 +2,7 @@
 
 #include <geodata/Geodata.h>
 
+#include <cstdint>
 #include <vector>
 
 namespace geodata {
@@ -20,14 +21,19 @@ public:
   explicit ExportBuffer(const Geodata &geodata);
 
   auto block(int x, int y) -> Block &;
-  auto column(int x, int y, int cx, int cy) const -> const Column &;
+  auto column(int x, int y, int cx, int cy) const -> Column;
   auto cell(int x, int y, int cx = 0, int cy = 0, int layer = 0) const
       -> const Cell &;
 
 private:
   std::vector<Block> m_blocks;
-  std::vector<Column> m_columns;
-  std::vector<const Cell *> m_cells;
+
+  // Cells sorted by column, column layers are stored in
+  // [m_offsets[column], m_offsets[column + 1]).
+  std::vector<std::uint32_t> m_offsets;
+  std::vector<Cell> m_cells;
+
+  auto column_index(int x, int y, int cx, int cy) const -> int;
 };
 
 } // namespace geodata
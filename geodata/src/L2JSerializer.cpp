@@ -93,7 +93,7 @@ void L2JSerializer::serialize(const Geodata &geodata,
       } else if (block.type == BLOCK_MULTILAYER) {
         for (auto cx = 0; cx < BLOCK_WIDTH_CELLS; ++cx) {
           for (auto cy = 0; cy < BLOCK_HEIGHT_CELLS; ++cy) {
-            const auto &column = buffer.column(x, y, cx, cy);
+            const auto column = buffer.column(x, y, cx, cy);
 
             output.put(column.layers);
 
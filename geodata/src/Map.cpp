@@ -4,9 +4,50 @@
 
 namespace geodata {
 
+// Triangles per mesh chunk.
+static constexpr std::size_t chunk_size = 256;
+
+static auto make_map_mesh(std::shared_ptr<const Mesh> mesh) -> MapMesh {
+  MapMesh map_mesh;
+  const auto chunk_index_count = chunk_size * 3;
+
+  for (std::size_t offset = 0; offset + 2 < mesh->indices.size();
+       offset += chunk_index_count) {
+
+    MeshChunk chunk;
+    chunk.index_offset = offset;
+    chunk.index_count =
+        std::min(chunk_index_count, (mesh->indices.size() - offset) / 3 * 3);
+
+    for (auto i = offset; i < offset + chunk.index_count; ++i) {
+      chunk.bounding_box += mesh->vertices.position(mesh->indices[i]);
+    }
+
+    map_mesh.bounding_box += chunk.bounding_box.min();
+    map_mesh.bounding_box += chunk.bounding_box.max();
+    map_mesh.chunks.push_back(chunk);
+  }
+
+  map_mesh.mesh = std::move(mesh);
+  return map_mesh;
+}
+
 void Map::add(const Entity &entity) {
   ASSERT(entity.mesh != nullptr, "Geodata", "Entity must have mesh");
 
+  const auto [cached, inserted] =
+      m_mesh_indices.try_emplace(entity.mesh.get(), m_meshes.size());
+
+  if (inserted) {
+    m_meshes.push_back(make_map_mesh(entity.mesh));
+  }
+
+  const auto &map_mesh = m_meshes[cached->second];
+
+  if (map_mesh.chunks.empty()) {
+    return;
+  }
+
   // Swap Y-up with Z-up for Recast.
   const auto identity = glm::mat4{
       {1.0f, 0.0f, 0.0f, 0.0f},
@@ -15,56 +56,31 @@ void Map::add(const Entity &entity) {
       {0.0f, 0.0f, 0.0f, 1.0f},
   };
 
-  std::vector<glm::vec3> normals;
-
   for (const auto &instance_matrix : entity.mesh->instance_matrices) {
-    const auto vertex_count = m_vertices.size();
     const auto model_matrix = identity * entity.model_matrix * instance_matrix;
-    const auto normal_matrix = glm::inverseTranspose(glm::mat3{model_matrix});
-
-    for (const auto &vertex : entity.mesh->vertices) {
-      m_vertices.emplace_back(model_matrix * glm::vec4{vertex.position, 1.0f});
-      normals.emplace_back(glm::normalize(normal_matrix * vertex.normal));
-    }
 
-    for (std::size_t index = 0; index < entity.mesh->indices.size();
-         index += 3) {
-
-      const auto index0 = entity.mesh->indices[index + 0];
-      const auto index1 = entity.mesh->indices[index + 1];
-      const auto index2 = entity.mesh->indices[index + 2];
-
-      // Try to fix winding.
-      const auto average_normal = glm::normalize(
-          (normals[index0] + normals[index1] + normals[index2]) / 3.0f);
-
-      const auto face_normal = glm::triangleNormal(
-          m_vertices[vertex_count + index2], m_vertices[vertex_count + index1],
-          m_vertices[vertex_count + index0]);
-
-      if (glm::dot(average_normal, face_normal) >= 0.0f) {
-        m_indices.push_back(vertex_count + index2);
-        m_indices.push_back(vertex_count + index1);
-        m_indices.push_back(vertex_count + index0);
-      } else {
-        m_indices.push_back(vertex_count + index0);
-        m_indices.push_back(vertex_count + index1);
-        m_indices.push_back(vertex_count + index2);
-      }
-    }
+    m_instances.push_back({
+        cached->second,
+        model_matrix,
+        math::Box{map_mesh.bounding_box, model_matrix},
+    });
   }
 }
 
+void Map::set_heightmap(std::shared_ptr<const Heightmap> heightmap) {
+  m_heightmap = std::move(heightmap);
+}
+
 auto Map::name() const -> const std::string & { return m_name; }
 
-auto Map::vertices() const -> const std::vector<glm::vec3> & {
-  return m_vertices;
-}
+auto Map::meshes() const -> const std::vector<MapMesh> & { return m_meshes; }
 
-auto Map::indices() const -> const std::vector<unsigned int> & {
-  return m_indices;
+auto Map::instances() const -> const std::vector<MeshInstance> & {
+  return m_instances;
 }
 
+auto Map::heightmap() const -> const Heightmap * { return m_heightmap.get(); }
+
 auto Map::bounding_box() const -> const math::Box & { return m_bounding_box; }
 
 } // namespace geodata
@@ -33,7 +33,7 @@ void Optimizer::optimize() {
 auto Optimizer::is_multilayer_block(int x, int y) const -> bool {
   for (auto cx = 0; cx < BLOCK_WIDTH_CELLS; ++cx) {
     for (auto cy = 0; cy < BLOCK_HEIGHT_CELLS; ++cy) {
-      const auto &column = m_buffer.column(x, y, cx, cy);
+      const auto column = m_buffer.column(x, y, cx, cy);
 
       ASSERT(column.layers > 0, "Geodata",
              "Column must have at least one layer: "
@@ -5,34 +5,337 @@
 // Оставь надежду всяк сюда смотрящий.
 namespace geodata {
 
-static constexpr auto RC_FLAT_AREA = 1;
-static constexpr auto RC_STEEP_AREA = 2;
-static constexpr auto RC_WALL_AREA = 3;
+// Quad half in quad space (u, v in [0, 1]): z = z + dz_du * u + dz_dv * v
+// where a * u + b * v + c >= 0.
+struct QuadTriangle {
+  float z;
+  float dz_du;
+  float dz_dv;
+  float a;
+  float b;
+  float c;
+  unsigned char area = RC_NULL_AREA;
+  int order = -1;
+};
 
-void mark_triangles(float walkable_angle, float wall_angle,
-                    const float *vertices, const int *triangles,
-                    std::size_t triangle_count, unsigned char *areas) {
+// Order of triangle in the terrain mesh, spans merging depends on it.
+static auto triangle_order(const Heightmap &heightmap, int x, int y,
+                           std::uint8_t flags, int triangle) -> int {
+
+  const auto quads_x = heightmap.width - 1;
+  const auto quads_y = heightmap.height - 1;
+  const auto south_base = 2 * quads_x * quads_y;
+  const auto east_base = south_base + 2 * quads_x + 4;
+  const auto southeast_base = east_base + 2 * quads_y + 4;
+
+  const auto south = (flags & QUAD_SOUTH_EDGE) != 0;
+  const auto east = (flags & QUAD_EAST_EDGE) != 0;
+
+  // Edge quad halves are emitted interleaved with neighbour quads.
+  if (south && east) {
+    return southeast_base + triangle;
+  }
+
+  if (south) {
+    return south_base + (triangle == 0 ? 2 * x : 2 * x + 3);
+  }
+
+  if (east) {
+    return east_base + (triangle == 0 ? 2 * y : 2 * y + 3);
+  }
+
+  return 2 * (x + y * quads_x) + triangle;
+}
+
+void rasterize_heightmap(rcContext *context, const Heightmap &heightmap,
+                         float walkable_angle, float wall_angle,
+                         rcHeightfield &hf) {
+
+  ASSERT(heightmap.scale.x != 0.0f && heightmap.scale.y != 0.0f, "Geodata",
+         "Heightmap scale must not be zero");
 
   const auto walkable_angle_radians = std::cos(glm::radians(walkable_angle));
   const auto wall_angle_radians = std::cos(glm::radians(wall_angle));
 
-  for (std::size_t i = 0; i < triangle_count; ++i) {
-    const auto *triangle = &triangles[i * 3];
-    const auto normal =
-        glm::triangleNormal(glm::make_vec3(&vertices[triangle[0] * 3]),
-                            glm::make_vec3(&vertices[triangle[1] * 3]),
-                            glm::make_vec3(&vertices[triangle[2] * 3]));
+  const auto quads_x = heightmap.width - 1;
+  const auto quads_y = heightmap.height - 1;
+
+  if (quads_x <= 0 || quads_y <= 0) {
+    return;
+  }
+
+  // Heightfield is in Recast space: X, Z (up), Y.
+  const auto to_u = [&heightmap](float x) {
+    return (x - heightmap.origin.x) / heightmap.scale.x;
+  };
+  const auto to_v = [&heightmap](float y) {
+    return (y - heightmap.origin.y) / heightmap.scale.y;
+  };
+
+  const auto hf_u0 = std::min(to_u(hf.bmin[0]), to_u(hf.bmax[0]));
+  const auto hf_u1 = std::max(to_u(hf.bmin[0]), to_u(hf.bmax[0]));
+  const auto hf_v0 = std::min(to_v(hf.bmin[2]), to_v(hf.bmax[2]));
+  const auto hf_v1 = std::max(to_v(hf.bmin[2]), to_v(hf.bmax[2]));
+
+  if (hf_u1 <= 0.0f || hf_v1 <= 0.0f ||
+      hf_u0 >= static_cast<float>(quads_x) ||
+      hf_v0 >= static_cast<float>(quads_y)) {
+    return;
+  }
+
+  const auto first_x =
+      std::clamp(static_cast<int>(std::floor(hf_u0)), 0, quads_x - 1);
+  const auto last_x =
+      std::clamp(static_cast<int>(std::ceil(hf_u1)) - 1, 0, quads_x - 1);
+  const auto first_y =
+      std::clamp(static_cast<int>(std::floor(hf_v0)), 0, quads_y - 1);
+  const auto last_y =
+      std::clamp(static_cast<int>(std::ceil(hf_v1)) - 1, 0, quads_y - 1);
+
+  // Prepare planes of quads covered by the heightfield.
+  const auto range_x = last_x - first_x + 1;
+  const auto range_y = last_y - first_y + 1;
+  std::vector<std::array<QuadTriangle, 2>> quads(range_x * range_y);
+
+  const auto gradient_scale_u = 1.0f / heightmap.scale.x;
+  const auto gradient_scale_v = 1.0f / heightmap.scale.y;
+
+  for (auto y = first_y; y <= last_y; ++y) {
+    for (auto x = first_x; x <= last_x; ++x) {
+      const auto flags = heightmap.quads[x + y * quads_x];
+      auto &triangles = quads[(x - first_x) + (y - first_y) * range_x];
+
+      // Invisible quads keep negative order.
+      if ((flags & QUAD_VISIBLE) == 0) {
+        continue;
+      }
+
+      const auto i00 = x + y * heightmap.width;
+      const auto i10 = (x + 1) + y * heightmap.width;
+      const auto i01 = x + (y + 1) * heightmap.width;
+      const auto i11 = (x + 1) + (y + 1) * heightmap.width;
+
+      const auto h00 = heightmap.heights[i00];
+      const auto h10 = heightmap.heights[i10];
+      const auto h01 = heightmap.heights[i01];
+      const auto h11 = heightmap.heights[i11];
+
+      std::array<std::array<int, 3>, 2> vertices{};
 
-    if (normal.y < -wall_angle_radians) {
-      continue;
+      if ((flags & QUAD_TURNED) == 0) {
+        triangles[0] = {h00, h10 - h00, h11 - h10, 1.0f, -1.0f, 0.0f};
+        triangles[1] = {h00, h11 - h01, h01 - h00, -1.0f, 1.0f, 0.0f};
+        vertices = {{{i00, i10, i11}, {i00, i11, i01}}};
+      } else {
+        triangles[0] = {h00, h10 - h00, h01 - h00, -1.0f, -1.0f, 1.0f};
+        triangles[1] = {h10 + h01 - h11, h11 - h01, h11 - h10,
+                        1.0f,            1.0f,      -1.0f};
+        vertices = {{{i00, i10, i01}, {i10, i11, i01}}};
+      }
+
+      for (auto i = 0; i < 2; ++i) {
+        auto &triangle = triangles[i];
+        const auto gradient_x = triangle.dz_du * gradient_scale_u;
+        const auto gradient_y = triangle.dz_dv * gradient_scale_v;
+
+        auto normal_y = 1.0f / std::sqrt(1.0f + gradient_x * gradient_x +
+                                         gradient_y * gradient_y);
+
+        // Winding follows vertex normals, like in Map::add.
+        if (!heightmap.normals.empty()) {
+          const auto vertex_normal = heightmap.normals[vertices[i][0]] +
+                                     heightmap.normals[vertices[i][1]] +
+                                     heightmap.normals[vertices[i][2]];
+
+          if (glm::dot(vertex_normal,
+                       glm::vec3{-gradient_x, -gradient_y, 1.0f}) < 0.0f) {
+            normal_y = -normal_y;
+          }
+        }
+
+        triangle.area =
+            triangle_area(normal_y, walkable_angle_radians, wall_angle_radians);
+        triangle.order = triangle_order(heightmap, x, y, flags, i);
+      }
     }
+  }
+
+  // Cell ranges in quad space, the same for every row or column.
+  struct CellRange {
+    int first_quad;
+    int last_quad;
+    float begin;
+    float end;
+  };
+
+  const auto cell_ranges = [&hf](int count, float bmin, auto to_quad,
+                                 int first_quad, int last_quad) {
+    std::vector<CellRange> ranges(count);
 
-    if (normal.y < wall_angle_radians) {
-      areas[i] = RC_WALL_AREA;
-    } else if (normal.y < walkable_angle_radians) {
-      areas[i] = RC_STEEP_AREA;
-    } else {
-      areas[i] = RC_FLAT_AREA;
+    for (auto i = 0; i < count; ++i) {
+      const auto cell_min = bmin + static_cast<float>(i) * hf.cs;
+      const auto begin = std::min(to_quad(cell_min), to_quad(cell_min + hf.cs));
+      const auto end = std::max(to_quad(cell_min), to_quad(cell_min + hf.cs));
+
+      ranges[i] = {
+          std::max(static_cast<int>(std::floor(begin)), first_quad),
+          std::min(static_cast<int>(std::ceil(end)) - 1, last_quad),
+          begin,
+          end,
+      };
+    }
+
+    return ranges;
+  };
+
+  const auto column_ranges =
+      cell_ranges(hf.width, hf.bmin[0], to_u, first_x, last_x);
+  const auto row_ranges =
+      cell_ranges(hf.height, hf.bmin[2], to_v, first_y, last_y);
+
+  // Rasterize columns.
+  const auto by = hf.bmax[1] - hf.bmin[1];
+  const auto ich = 1.0f / hf.ch;
+
+  struct ColumnSpan {
+    int order;
+    float min_z;
+    float max_z;
+    unsigned char area;
+  };
+
+  std::vector<ColumnSpan> column_spans;
+
+  for (auto cell_y = 0; cell_y < hf.height; ++cell_y) {
+    const auto &row = row_ranges[cell_y];
+
+    for (auto cell_x = 0; cell_x < hf.width; ++cell_x) {
+      const auto &column = column_ranges[cell_x];
+
+      column_spans.clear();
+
+      for (auto quad_y = row.first_quad; quad_y <= row.last_quad; ++quad_y) {
+        for (auto quad_x = column.first_quad; quad_x <= column.last_quad;
+             ++quad_x) {
+
+          const auto &triangles =
+              quads[(quad_x - first_x) + (quad_y - first_y) * range_x];
+
+          if (triangles[0].order < 0) {
+            continue;
+          }
+
+          // Cell rectangle in quad space.
+          const auto qu0 =
+              std::max(column.begin - static_cast<float>(quad_x), 0.0f);
+          const auto qu1 =
+              std::min(column.end - static_cast<float>(quad_x), 1.0f);
+          const auto qv0 = std::max(row.begin - static_cast<float>(quad_y), 0.0f);
+          const auto qv1 = std::min(row.end - static_cast<float>(quad_y), 1.0f);
+
+          if (qu1 <= qu0 || qv1 <= qv0) {
+            continue;
+          }
+
+          const std::array<glm::vec2, 4> corners = {
+              glm::vec2{qu0, qv0},
+              glm::vec2{qu1, qv0},
+              glm::vec2{qu1, qv1},
+              glm::vec2{qu0, qv1},
+          };
+
+          for (const auto &triangle : triangles) {
+            std::array<float, 4> sides{};
+            auto min_side = std::numeric_limits<float>::max();
+            auto max_side = 0.0f;
+
+            for (auto i = 0; i < 4; ++i) {
+              sides[i] = triangle.a * corners[i].x + triangle.b * corners[i].y +
+                         triangle.c;
+              min_side = std::min(min_side, sides[i]);
+              max_side = std::max(max_side, sides[i]);
+            }
+
+            // Touching only.
+            if (max_side <= 0.0f) {
+              continue;
+            }
+
+            // Height is linear, so it's enough to check vertices of the
+            // clipped rectangle.
+            auto min_z = triangle.z;
+            auto max_z = triangle.z;
+
+            if (min_side >= 0.0f) {
+              // Whole rectangle is inside, extremes are in its corners.
+              min_z += triangle.dz_du * (triangle.dz_du < 0.0f ? qu1 : qu0) +
+                       triangle.dz_dv * (triangle.dz_dv < 0.0f ? qv1 : qv0);
+              max_z += triangle.dz_du * (triangle.dz_du < 0.0f ? qu0 : qu1) +
+                       triangle.dz_dv * (triangle.dz_dv < 0.0f ? qv0 : qv1);
+            } else {
+              min_z = std::numeric_limits<float>::max();
+              max_z = std::numeric_limits<float>::lowest();
+
+              const auto add_point = [&triangle, &min_z,
+                                      &max_z](const glm::vec2 &point) {
+                const auto z = triangle.z + triangle.dz_du * point.x +
+                               triangle.dz_dv * point.y;
+                min_z = std::min(min_z, z);
+                max_z = std::max(max_z, z);
+              };
+
+              for (auto i = 0; i < 4; ++i) {
+                const auto j = (i + 1) % 4;
+
+                if (sides[i] >= 0.0f) {
+                  add_point(corners[i]);
+                }
+
+                if ((sides[i] > 0.0f && sides[j] < 0.0f) ||
+                    (sides[i] < 0.0f && sides[j] > 0.0f)) {
+                  const auto t = sides[i] / (sides[i] - sides[j]);
+                  add_point(corners[i] + (corners[j] - corners[i]) * t);
+                }
+              }
+            }
+
+            column_spans.push_back(
+                {triangle.order, min_z, max_z, triangle.area});
+          }
+        }
+      }
+
+      // Edge quads interleave orders, so even two spans can be out of order.
+      if (column_spans.size() > 1) {
+        std::sort(column_spans.begin(), column_spans.end(),
+                  [](const ColumnSpan &left, const ColumnSpan &right) {
+                    return left.order < right.order;
+                  });
+      }
+
+      // Same quantization as Recast triangle rasterization.
+      for (const auto &column_span : column_spans) {
+        auto min_z = column_span.min_z - hf.bmin[1];
+        auto max_z = column_span.max_z - hf.bmin[1];
+
+        if (max_z < 0.0f || min_z > by) {
+          continue;
+        }
+
+        min_z = std::max(min_z, 0.0f);
+        max_z = std::min(max_z, by);
+
+        const auto span_min = std::clamp(
+            static_cast<int>(std::floor(min_z * ich)), 0, RC_SPAN_MAX_HEIGHT);
+        const auto span_max =
+            std::clamp(static_cast<int>(std::ceil(max_z * ich)), span_min + 1,
+                       RC_SPAN_MAX_HEIGHT);
+
+        rcAddSpan(context, hf, cell_x, cell_y,
+                  static_cast<unsigned short>(span_min),
+                  static_cast<unsigned short>(span_max), column_span.area, 0,
+                  0);
+      }
     }
   }
 }
@@ -55,89 +358,187 @@ void merge_heightfields(rcContext *context, const rcHeightfield &source,
   }
 }
 
-void calculate_nswe(const rcHeightfield &hf, int walkable_height,
-                    int min_walkable_climb, int max_walkable_climb) {
+static constexpr auto max_span_height = 0xffff;
 
-  const auto max_height = 0xffff;
+auto make_compact_heightfield(const rcHeightfield &hf) -> CompactHeightfield {
+  CompactHeightfield chf{};
+  chf.width = hf.width;
+  chf.height = hf.height;
+  chf.columns.reserve(static_cast<std::size_t>(hf.width) * hf.height + 1);
 
-  for (auto y = 0; y < hf.height; ++y) {
-    for (auto x = 0; x < hf.width; ++x) {
-      for (auto *span = hf.spans[x + y * hf.width]; span != nullptr;
-           span = span->next) {
+  for (auto i = 0; i < hf.width * hf.height; ++i) {
+    chf.columns.push_back(static_cast<std::uint32_t>(chf.spans.size()));
+
+    for (const auto *span = hf.spans[i]; span != nullptr; span = span->next) {
+      chf.spans.push_back({
+          static_cast<std::uint16_t>(span->smax),
+          static_cast<std::uint16_t>(span->mmax),
+          static_cast<std::uint16_t>(span->next != nullptr ? span->next->smin
+                                                           : max_span_height),
+          span->area,
+          0,
+          {NO_NEIGHBOUR_SPAN, NO_NEIGHBOUR_SPAN, NO_NEIGHBOUR_SPAN,
+           NO_NEIGHBOUR_SPAN},
+      });
+    }
+  }
+
+  chf.columns.push_back(static_cast<std::uint32_t>(chf.spans.size()));
+  return chf;
+}
+
+void filter_low_height_spans(CompactHeightfield &chf, int walkable_height) {
+  for (auto &span : chf.spans) {
+    if (static_cast<int>(span.top) - static_cast<int>(span.bottom) <=
+        walkable_height) {
+
+      span.area = RC_NULL_AREA;
+    }
+  }
+}
+
+// Spans only write own fields and read neighbour areas and heights, so rows
+// are independent.
+template <typename F>
+static void for_each_row(const CompactHeightfield &chf,
+                         std::size_t thread_count, F process_row) {
+
+  if (thread_count <= 1 || chf.height <= 1) {
+    for (auto y = 0; y < chf.height; ++y) {
+      process_row(y);
+    }
+
+    return;
+  }
+
+  utils::ThreadPool pool{
+      std::min(thread_count, static_cast<std::size_t>(chf.height))};
+  std::atomic_int next_row = 0;
+  std::vector<std::future<void>> futures;
 
-        const auto area = static_cast<int>(span->area) & 0xf;
+  for (std::size_t i = 0; i < pool.thread_count(); ++i) {
+    futures.push_back(pool.submit([&chf, &next_row, &process_row] {
+      for (auto y = next_row++; y < chf.height; y = next_row++) {
+        process_row(y);
+      }
+    }));
+  }
+
+  for (auto &future : futures) {
+    future.get();
+  }
+}
 
-        if (area == RC_NULL_AREA) {
+void link_neighbour_spans(CompactHeightfield &chf, int walkable_height,
+                          std::size_t thread_count) {
+
+  for_each_row(chf, thread_count, [&chf, walkable_height](int y) {
+    for (auto x = 0; x < chf.width; ++x) {
+      const auto column = x + y * chf.width;
+
+      for (auto i = chf.columns[column]; i < chf.columns[column + 1]; ++i) {
+        auto &span = chf.spans[i];
+
+        if (span.area == RC_NULL_AREA) {
           continue;
         }
 
-        const auto bottom = static_cast<int>(span->smax);
-        const auto top = span->next != nullptr
-                             ? static_cast<int>(span->next->smin)
-                             : max_height;
-
-        span->area &= 0xf;
+        const auto bottom = static_cast<int>(span.bottom);
+        const auto top = static_cast<int>(span.top);
 
         for (auto direction = 0; direction < 4; ++direction) {
           const auto dx = x + rcGetDirOffsetX(direction);
           const auto dy = y + rcGetDirOffsetY(direction);
 
-          if (dx < 0 || dy < 0 || dx >= hf.width || dy >= hf.height) {
-            span->area |= 1 << (direction + 4);
+          if (dx < 0 || dy < 0 || dx >= chf.width || dy >= chf.height) {
+            span.neighbours[direction] = OUTSIDE_NEIGHBOUR_SPAN;
             continue;
           }
 
-          auto direction_allowed = false;
+          const auto neighbour_column = dx + dy * chf.width;
+          span.neighbours[direction] = NO_NEIGHBOUR_SPAN;
 
-          for (auto *neighbour = hf.spans[dx + dy * hf.width];
-               neighbour != nullptr; neighbour = neighbour->next) {
+          for (auto j = chf.columns[neighbour_column];
+               j < chf.columns[neighbour_column + 1]; ++j) {
 
-            const auto neighbour_area = static_cast<int>(neighbour->area) & 0xf;
+            const auto &neighbour = chf.spans[j];
 
-            if (neighbour_area == RC_NULL_AREA) {
-              direction_allowed = false;
+            if (neighbour.area == RC_NULL_AREA) {
               continue;
             }
 
-            const auto neighbour_bottom = static_cast<int>(neighbour->smax);
-            const auto merged_neighbour_bottom =
-                static_cast<int>(neighbour->mmax);
-            const auto neighbour_top =
-                neighbour->next != nullptr
-                    ? static_cast<int>(neighbour->next->smin)
-                    : max_height;
-
-            const auto height = std::min(top, neighbour_top) -
-                                std::max(bottom, neighbour_bottom);
+            const auto height =
+                std::min(top, static_cast<int>(neighbour.top)) -
+                std::max(bottom, static_cast<int>(neighbour.bottom));
 
             if (height >= walkable_height) {
-              if (neighbour_area == RC_WALL_AREA) {
-                if (bottom < merged_neighbour_bottom) {
-                  direction_allowed =
-                      (merged_neighbour_bottom - bottom) <= min_walkable_climb;
-                } else {
-                  direction_allowed =
-                      (neighbour_bottom - bottom) <= min_walkable_climb;
-                }
-              } else if (neighbour_area == RC_STEEP_AREA) {
-                direction_allowed =
-                    (neighbour_bottom - bottom) <= min_walkable_climb;
-              } else {
-                direction_allowed =
-                    (neighbour_bottom - bottom) <= max_walkable_climb;
-              }
-
+              span.neighbours[direction] = j;
               break;
             }
           }
+        }
+      }
+    }
+  });
+}
+
+void calculate_nswe(CompactHeightfield &chf, int min_walkable_climb,
+                    int max_walkable_climb, std::size_t thread_count) {
 
-          if (direction_allowed) {
-            span->area |= 1 << (direction + 4);
+  for_each_row(chf, thread_count, [&chf, min_walkable_climb,
+                                   max_walkable_climb](int y) {
+    const auto first_span = chf.columns[y * chf.width];
+    const auto last_span = chf.columns[(y + 1) * chf.width];
+
+    for (auto i = first_span; i < last_span; ++i) {
+      auto &span = chf.spans[i];
+
+      if (span.area == RC_NULL_AREA) {
+        continue;
+      }
+
+      const auto bottom = static_cast<int>(span.bottom);
+
+      for (auto direction = 0; direction < 4; ++direction) {
+        const auto link = span.neighbours[direction];
+
+        if (link == NO_NEIGHBOUR_SPAN) {
+          continue;
+        }
+
+        if (link == OUTSIDE_NEIGHBOUR_SPAN) {
+          span.nswe |= 1 << direction;
+          continue;
+        }
+
+        const auto &neighbour = chf.spans[link];
+        const auto neighbour_area = static_cast<int>(neighbour.area);
+        const auto neighbour_bottom = static_cast<int>(neighbour.bottom);
+        const auto merged_neighbour_bottom =
+            static_cast<int>(neighbour.merged_bottom);
+
+        auto direction_allowed = false;
+
+        if (neighbour_area == RC_WALL_AREA) {
+          if (bottom < merged_neighbour_bottom) {
+            direction_allowed =
+                (merged_neighbour_bottom - bottom) <= min_walkable_climb;
+          } else {
+            direction_allowed =
+                (neighbour_bottom - bottom) <= min_walkable_climb;
           }
+        } else if (neighbour_area == RC_STEEP_AREA) {
+          direction_allowed = (neighbour_bottom - bottom) <= min_walkable_climb;
+        } else {
+          direction_allowed = (neighbour_bottom - bottom) <= max_walkable_climb;
+        }
+
+        if (direction_allowed) {
+          span.nswe |= 1 << direction;
         }
       }
     }
-  }
+  });
 }
 
 } // namespace geodata
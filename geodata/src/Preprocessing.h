@@ -1,17 +1,62 @@
 #pragma once
 
 #include "Recast.h"
+#include "TriangleAreas.h"
+
+#include <geodata/Heightmap.h>
+
+#include <cstdint>
+#include <vector>
 
 namespace geodata {
 
-void mark_triangles(float walkable_angle, float wall_angle,
-                    const float *vertices, const int *triangles,
-                    std::size_t triangle_count, unsigned char *areas);
+// Rasterizes terrain quads directly into heightfield columns. Spans are the
+// same as rasterized terrain triangles would give.
+void rasterize_heightmap(rcContext *context, const Heightmap &heightmap,
+                         float walkable_angle, float wall_angle,
+                         rcHeightfield &hf);
 
 void merge_heightfields(rcContext *context, const rcHeightfield &source,
                         rcHeightfield &destination, int min_walkable_climb);
 
-void calculate_nswe(const rcHeightfield &hf, int walkable_height,
-                    int min_walkable_climb, int max_walkable_climb);
+// Neighbour span links, besides span indices.
+static constexpr std::uint32_t NO_NEIGHBOUR_SPAN = 0xffffffff;
+static constexpr std::uint32_t OUTSIDE_NEIGHBOUR_SPAN = 0xfffffffe;
+
+struct CompactSpan {
+  std::uint16_t bottom;        // Span smax.
+  std::uint16_t merged_bottom; // Span mmax.
+  std::uint16_t top;           // Next span smin or max height.
+  std::uint8_t area;
+  std::uint8_t nswe;
+
+  // First walkable span of the neighbour column with enough height to pass
+  // from this span, per direction.
+  std::uint32_t neighbours[4];
+};
+
+// Heightfield spans in one array, columns in row order, similar to
+// rcCompactHeightfield.
+struct CompactHeightfield {
+  int width;
+  int height;
+
+  // Column spans are [columns[i], columns[i + 1]), bottom to top.
+  std::vector<std::uint32_t> columns;
+  std::vector<CompactSpan> spans;
+};
+
+auto make_compact_heightfield(const rcHeightfield &hf) -> CompactHeightfield;
+
+// Same as rcFilterWalkableLowHeightSpans.
+void filter_low_height_spans(CompactHeightfield &chf, int walkable_height);
+
+// Must be called after filtering, null spans aren't linked. Rows are
+// processed in parallel with more than one thread.
+void link_neighbour_spans(CompactHeightfield &chf, int walkable_height,
+                          std::size_t thread_count);
+
+void calculate_nswe(CompactHeightfield &chf, int min_walkable_climb,
+                    int max_walkable_climb, std::size_t thread_count);
 
 } // namespace geodata
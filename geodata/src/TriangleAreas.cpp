@@ -0,0 +1,292 @@
+#include "pch.h"
+
+#include "TriangleAreas.h"
+
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define GEODATA_X86_KERNELS 1
+#include <cpuid.h>
+#include <immintrin.h>
+#endif
+
+namespace geodata {
+
+static constexpr std::size_t block_size = 256;
+
+// Positions of block triangles: vertex, axis, triangle.
+struct TriangleBlock {
+  alignas(32) float positions[3][3][block_size];
+};
+
+static void gather_block(const float *vertices, const int *triangles,
+                         std::size_t count, TriangleBlock &block) {
+
+  for (std::size_t i = 0; i < count; ++i) {
+    for (auto vertex = 0; vertex < 3; ++vertex) {
+      const auto *position = &vertices[triangles[i * 3 + vertex] * 3];
+
+      block.positions[vertex][0][i] = position[0];
+      block.positions[vertex][1][i] = position[1];
+      block.positions[vertex][2][i] = position[2];
+    }
+  }
+}
+
+// Y of glm::triangleNormal(v0, v1, v2) with the same operations in the same
+// order, SIMD kernels repeat them lane-wise to give identical results.
+static auto block_normal_y(const TriangleBlock &block, std::size_t i) -> float {
+
+  const auto &p = block.positions;
+
+  const auto ax = p[0][0][i] - p[1][0][i];
+  const auto ay = p[0][1][i] - p[1][1][i];
+  const auto az = p[0][2][i] - p[1][2][i];
+  const auto bx = p[0][0][i] - p[2][0][i];
+  const auto by = p[0][1][i] - p[2][1][i];
+  const auto bz = p[0][2][i] - p[2][2][i];
+
+  const auto nx = ay * bz - by * az;
+  const auto ny = az * bx - bz * ax;
+  const auto nz = ax * by - bx * ay;
+
+  const auto length2 = nx * nx + ny * ny + nz * nz;
+  return ny * (1.0f / std::sqrt(length2));
+}
+
+#if GEODATA_X86_KERNELS
+
+__attribute__((target("sse4.1"))) static void
+mark_block_sse41(const TriangleBlock &block, std::size_t count,
+                 float walkable_angle_radians, float wall_angle_radians,
+                 unsigned char *areas) {
+
+  const auto &p = block.positions;
+
+  const auto one = _mm_set1_ps(1.0f);
+  const auto walkable = _mm_set1_ps(walkable_angle_radians);
+  const auto wall = _mm_set1_ps(wall_angle_radians);
+  const auto ceiling = _mm_set1_ps(-wall_angle_radians);
+
+  const auto null_area = _mm_set1_epi32(RC_NULL_AREA);
+  const auto flat_area = _mm_set1_epi32(RC_FLAT_AREA);
+  const auto steep_area = _mm_set1_epi32(RC_STEEP_AREA);
+  const auto wall_area = _mm_set1_epi32(RC_WALL_AREA);
+
+  std::size_t i = 0;
+
+  for (; i + 4 <= count; i += 4) {
+    const auto ax =
+        _mm_sub_ps(_mm_load_ps(&p[0][0][i]), _mm_load_ps(&p[1][0][i]));
+    const auto ay =
+        _mm_sub_ps(_mm_load_ps(&p[0][1][i]), _mm_load_ps(&p[1][1][i]));
+    const auto az =
+        _mm_sub_ps(_mm_load_ps(&p[0][2][i]), _mm_load_ps(&p[1][2][i]));
+    const auto bx =
+        _mm_sub_ps(_mm_load_ps(&p[0][0][i]), _mm_load_ps(&p[2][0][i]));
+    const auto by =
+        _mm_sub_ps(_mm_load_ps(&p[0][1][i]), _mm_load_ps(&p[2][1][i]));
+    const auto bz =
+        _mm_sub_ps(_mm_load_ps(&p[0][2][i]), _mm_load_ps(&p[2][2][i]));
+
+    const auto nx = _mm_sub_ps(_mm_mul_ps(ay, bz), _mm_mul_ps(by, az));
+    const auto ny = _mm_sub_ps(_mm_mul_ps(az, bx), _mm_mul_ps(bz, ax));
+    const auto nz = _mm_sub_ps(_mm_mul_ps(ax, by), _mm_mul_ps(bx, ay));
+
+    const auto length2 = _mm_add_ps(
+        _mm_add_ps(_mm_mul_ps(nx, nx), _mm_mul_ps(ny, ny)), _mm_mul_ps(nz, nz));
+    const auto normal_y = _mm_mul_ps(ny, _mm_div_ps(one, _mm_sqrt_ps(length2)));
+
+    // Same priority as triangle_area, NaN normals are flat.
+    auto area = flat_area;
+    area = _mm_blendv_epi8(area, steep_area,
+                           _mm_castps_si128(_mm_cmplt_ps(normal_y, walkable)));
+    area = _mm_blendv_epi8(area, wall_area,
+                           _mm_castps_si128(_mm_cmplt_ps(normal_y, wall)));
+    area = _mm_blendv_epi8(area, null_area,
+                           _mm_castps_si128(_mm_cmplt_ps(normal_y, ceiling)));
+
+    const auto packed = _mm_cvtsi128_si32(
+        _mm_packus_epi16(_mm_packs_epi32(area, area), _mm_setzero_si128()));
+    std::memcpy(&areas[i], &packed, 4);
+  }
+
+  for (; i < count; ++i) {
+    areas[i] = triangle_area(block_normal_y(block, i), walkable_angle_radians,
+                             wall_angle_radians);
+  }
+}
+
+__attribute__((target("avx2"))) static void
+mark_block_avx2(const TriangleBlock &block, std::size_t count,
+                float walkable_angle_radians, float wall_angle_radians,
+                unsigned char *areas) {
+
+  const auto &p = block.positions;
+
+  const auto one = _mm256_set1_ps(1.0f);
+  const auto walkable = _mm256_set1_ps(walkable_angle_radians);
+  const auto wall = _mm256_set1_ps(wall_angle_radians);
+  const auto ceiling = _mm256_set1_ps(-wall_angle_radians);
+
+  const auto null_area = _mm256_set1_epi32(RC_NULL_AREA);
+  const auto flat_area = _mm256_set1_epi32(RC_FLAT_AREA);
+  const auto steep_area = _mm256_set1_epi32(RC_STEEP_AREA);
+  const auto wall_area = _mm256_set1_epi32(RC_WALL_AREA);
+
+  std::size_t i = 0;
+
+  for (; i + 8 <= count; i += 8) {
+    const auto ax =
+        _mm256_sub_ps(_mm256_load_ps(&p[0][0][i]), _mm256_load_ps(&p[1][0][i]));
+    const auto ay =
+        _mm256_sub_ps(_mm256_load_ps(&p[0][1][i]), _mm256_load_ps(&p[1][1][i]));
+    const auto az =
+        _mm256_sub_ps(_mm256_load_ps(&p[0][2][i]), _mm256_load_ps(&p[1][2][i]));
+    const auto bx =
+        _mm256_sub_ps(_mm256_load_ps(&p[0][0][i]), _mm256_load_ps(&p[2][0][i]));
+    const auto by =
+        _mm256_sub_ps(_mm256_load_ps(&p[0][1][i]), _mm256_load_ps(&p[2][1][i]));
+    const auto bz =
+        _mm256_sub_ps(_mm256_load_ps(&p[0][2][i]), _mm256_load_ps(&p[2][2][i]));
+
+    const auto nx = _mm256_sub_ps(_mm256_mul_ps(ay, bz), _mm256_mul_ps(by, az));
+    const auto ny = _mm256_sub_ps(_mm256_mul_ps(az, bx), _mm256_mul_ps(bz, ax));
+    const auto nz = _mm256_sub_ps(_mm256_mul_ps(ax, by), _mm256_mul_ps(bx, ay));
+
+    const auto length2 = _mm256_add_ps(
+        _mm256_add_ps(_mm256_mul_ps(nx, nx), _mm256_mul_ps(ny, ny)),
+        _mm256_mul_ps(nz, nz));
+    const auto normal_y =
+        _mm256_mul_ps(ny, _mm256_div_ps(one, _mm256_sqrt_ps(length2)));
+
+    // Same priority as triangle_area, NaN normals are flat.
+    auto area = flat_area;
+    area = _mm256_blendv_epi8(
+        area, steep_area,
+        _mm256_castps_si256(_mm256_cmp_ps(normal_y, walkable, _CMP_LT_OQ)));
+    area = _mm256_blendv_epi8(
+        area, wall_area,
+        _mm256_castps_si256(_mm256_cmp_ps(normal_y, wall, _CMP_LT_OQ)));
+    area = _mm256_blendv_epi8(
+        area, null_area,
+        _mm256_castps_si256(_mm256_cmp_ps(normal_y, ceiling, _CMP_LT_OQ)));
+
+    const auto words = _mm_packs_epi32(_mm256_castsi256_si128(area),
+                                       _mm256_extracti128_si256(area, 1));
+    _mm_storel_epi64(reinterpret_cast<__m128i *>(&areas[i]),
+                     _mm_packus_epi16(words, words));
+  }
+
+  for (; i < count; ++i) {
+    areas[i] = triangle_area(block_normal_y(block, i), walkable_angle_radians,
+                             wall_angle_radians);
+  }
+}
+
+static auto detect_triangle_kernel() -> TriangleKernel {
+  unsigned int eax = 0;
+  unsigned int ebx = 0;
+  unsigned int ecx = 0;
+  unsigned int edx = 0;
+
+  if (__get_cpuid(1, &eax, &ebx, &ecx, &edx) == 0) {
+    return TriangleKernel::Scalar;
+  }
+
+  const auto sse41 = (ecx & bit_SSE4_1) != 0;
+  auto avx = (ecx & bit_AVX) != 0 && (ecx & bit_OSXSAVE) != 0;
+
+  // OS must save YMM registers.
+  if (avx) {
+    unsigned int xcr0 = 0;
+    unsigned int xcr0_high = 0;
+    __asm__("xgetbv" : "=a"(xcr0), "=d"(xcr0_high) : "c"(0));
+    avx = (xcr0 & 0x6) == 0x6;
+  }
+
+  if (avx && __get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx) != 0 &&
+      (ebx & bit_AVX2) != 0) {
+
+    return TriangleKernel::AVX2;
+  }
+
+  return sse41 ? TriangleKernel::SSE41 : TriangleKernel::Scalar;
+}
+
+#else
+
+static auto detect_triangle_kernel() -> TriangleKernel {
+  return TriangleKernel::Scalar;
+}
+
+#endif
+
+auto best_triangle_kernel() -> TriangleKernel {
+  static const auto kernel = detect_triangle_kernel();
+  return kernel;
+}
+
+auto triangle_kernel_name(TriangleKernel kernel) -> const char * {
+  switch (kernel) {
+  case TriangleKernel::Scalar:
+    return "Scalar";
+  case TriangleKernel::SSE41:
+    return "SSE4.1";
+  case TriangleKernel::AVX2:
+    return "AVX2";
+  }
+
+  return "Unknown";
+}
+
+void mark_triangles(float walkable_angle, float wall_angle,
+                    const float *vertices, const int *triangles,
+                    std::size_t triangle_count, unsigned char *areas) {
+
+  mark_triangles(walkable_angle, wall_angle, vertices, triangles,
+                 triangle_count, areas, best_triangle_kernel());
+}
+
+void mark_triangles(float walkable_angle, float wall_angle,
+                    const float *vertices, const int *triangles,
+                    std::size_t triangle_count, unsigned char *areas,
+                    TriangleKernel kernel) {
+
+  const auto walkable_angle_radians = std::cos(glm::radians(walkable_angle));
+  const auto wall_angle_radians = std::cos(glm::radians(wall_angle));
+
+#if GEODATA_X86_KERNELS
+  if (kernel != TriangleKernel::Scalar) {
+    const auto mark_block = kernel == TriangleKernel::AVX2 ? mark_block_avx2
+                                                           : mark_block_sse41;
+    TriangleBlock block;
+
+    for (std::size_t offset = 0; offset < triangle_count;
+         offset += block_size) {
+
+      const auto count = std::min(block_size, triangle_count - offset);
+      gather_block(vertices, &triangles[offset * 3], count, block);
+      mark_block(block, count, walkable_angle_radians, wall_angle_radians,
+                 &areas[offset]);
+    }
+
+    return;
+  }
+#else
+  static_cast<void>(kernel);
+#endif
+
+  for (std::size_t i = 0; i < triangle_count; ++i) {
+    const auto *triangle = &triangles[i * 3];
+    const auto normal =
+        glm::triangleNormal(glm::make_vec3(&vertices[triangle[0] * 3]),
+                            glm::make_vec3(&vertices[triangle[1] * 3]),
+                            glm::make_vec3(&vertices[triangle[2] * 3]));
+
+    areas[i] =
+        triangle_area(normal.y, walkable_angle_radians, wall_angle_radians);
+  }
+}
+
+} // namespace geodata
@@ -0,0 +1,52 @@
+#pragma once
+
+#include "Recast.h"
+
+#include <cstddef>
+
+namespace geodata {
+
+static constexpr auto RC_FLAT_AREA = 1;
+static constexpr auto RC_STEEP_AREA = 2;
+static constexpr auto RC_WALL_AREA = 3;
+
+inline auto triangle_area(float normal_y, float walkable_angle_radians,
+                          float wall_angle_radians) -> unsigned char {
+
+  if (normal_y < -wall_angle_radians) {
+    return RC_NULL_AREA;
+  }
+
+  if (normal_y < wall_angle_radians) {
+    return RC_WALL_AREA;
+  }
+
+  if (normal_y < walkable_angle_radians) {
+    return RC_STEEP_AREA;
+  }
+
+  return RC_FLAT_AREA;
+}
+
+enum class TriangleKernel {
+  Scalar,
+  SSE41,
+  AVX2,
+};
+
+// Fastest kernel supported by CPU, detected once.
+auto best_triangle_kernel() -> TriangleKernel;
+
+auto triangle_kernel_name(TriangleKernel kernel) -> const char *;
+
+// Marks triangles with areas by their slope. All kernels give the same areas.
+void mark_triangles(float walkable_angle, float wall_angle,
+                    const float *vertices, const int *triangles,
+                    std::size_t triangle_count, unsigned char *areas);
+
+void mark_triangles(float walkable_angle, float wall_angle,
+                    const float *vertices, const int *triangles,
+                    std::size_t triangle_count, unsigned char *areas,
+                    TriangleKernel kernel);
+
+} // namespace geodata
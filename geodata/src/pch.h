@@ -3,6 +3,7 @@
 #include <utils/Assert.h>
 #include <utils/ExtractionHelpers.h>
 #include <utils/Log.h>
+#include <utils/ThreadPool.h>
 
 #include <math/Box.h>
 #include <math/Transformation.h>
@@ -17,11 +18,16 @@
 
 #include <algorithm>
 #include <array>
+#include <atomic>
 #include <bitset>
 #include <cmath>
+#include <cstdint>
 #include <filesystem>
 #include <fstream>
+#include <future>
 #include <iostream>
+#include <limits>
+#include <memory>
 #include <sstream>
 #include <string>
 #include <unordered_map>
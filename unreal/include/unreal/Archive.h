@@ -1,19 +1,28 @@
 #pragma once
 
 #include "Index.h"
+#include "LoadProfile.h"
 #include "Name.h"
 #include "NameTable.h"
 #include "ObjectLoader.h"
 #include "PropertyExtractor.h"
 
+#include <utils/Assert.h>
 #include <utils/ExtractionHelpers.h>
 #include <utils/NonCopyable.h>
 
+#include <algorithm>
+#include <cstddef>
 #include <cstdint>
+#include <cstring>
+#include <future>
 #include <iostream>
 #include <memory>
-#include <sstream>
+#include <mutex>
+#include <span>
 #include <string>
+#include <string_view>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
@@ -40,7 +49,8 @@ struct ObjectExport {
   Index serial_size;
   Index serial_offset;
 
-  std::shared_ptr<Object> object;
+  // Set on first request, concurrent requests wait for the same object.
+  std::shared_future<std::shared_ptr<Object>> object;
 };
 
 struct GUID {
@@ -77,14 +87,12 @@ struct PackageHeader {
 };
 
 class Archive : public utils::NonCopyable {
-private:
-  mutable NameTable m_name_table;
-
 public:
   const ObjectLoader object_loader;
   const PropertyExtractor property_extractor;
 
   const Name name;
+  const LoadProfile profile;
 
   PackageHeader header;
 
@@ -92,22 +100,92 @@ public:
   std::vector<ObjectImport> import_map;
   std::vector<ObjectExport> export_map;
 
-  explicit Archive(const std::string &name, std::stringstream input,
+  explicit Archive(const std::string &name, std::vector<std::uint8_t> buffer,
                    const ArchiveLoader &archive_loader);
 
-  Archive(Archive &&other)
-      : object_loader{other.object_loader},
-        property_extractor{other.property_extractor}, name{std::move(
-                                                          other.name)},
-        header{std::move(other.header)}, name_map{std::move(other.name_map)},
-        import_map{std::move(other.import_map)},
-        export_map{std::move(other.export_map)}, m_input{std::move(
-                                                     other.m_input)} {}
+  // Read position of the current thread. While cursor is alive, reads of
+  // the archive on this thread start at its own position, so objects of one
+  // package can be deserialized concurrently.
+  class Cursor : public utils::NonCopyable {
+  public:
+    explicit Cursor(Archive &archive, std::size_t position);
+    ~Cursor();
+
+  private:
+    const Archive &m_archive;
+    std::size_t m_position;
+    Cursor *m_previous;
+
+    friend class Archive;
+  };
+
+  // Copies `size` bytes from the current position and advances it. Reading
+  // past the end zero-fills the rest of the destination.
+  void read(char *destination, std::size_t size) {
+    auto &position = this->position();
+    const auto available = std::min(size, m_buffer.size() - position);
+
+    if (available < size) {
+      ASSERT(false, "Unreal",
+             "Read past the end of package " << name << " at " << position);
+      std::memset(destination + available, 0, size - available);
+    }
+
+    std::memcpy(destination, m_buffer.data() + position, available);
+    position += available;
+  }
+
+  // Returns next `size` bytes without copying and advances position.
+  auto view(std::size_t size) -> std::span<const std::uint8_t> {
+    auto &position = this->position();
+    ASSERT(size <= m_buffer.size() - position, "Unreal",
+           "View past the end of package " << name << " at " << position);
+    size = std::min(size, m_buffer.size() - position);
+    const auto span =
+        std::span<const std::uint8_t>{m_buffer}.subspan(position, size);
+    position += size;
+    return span;
+  }
+
+  // Returns `size` bytes at `position` without copying, position is unchanged.
+  auto view(std::size_t position, std::size_t size) const
+      -> std::span<const std::uint8_t> {
+
+    ASSERT(position <= m_buffer.size() && size <= m_buffer.size() - position,
+           "Unreal", "View past the end of package " << name << " at "
+                                                     << position);
+    position = std::min(position, m_buffer.size());
+    size = std::min(size, m_buffer.size() - position);
+    return std::span<const std::uint8_t>{m_buffer}.subspan(position, size);
+  }
+
+  auto tell() const -> std::size_t {
+    return m_cursor != nullptr && &m_cursor->m_archive == this
+               ? m_cursor->m_position
+               : m_position;
+  }
+
+  void seek(std::size_t position) {
+    ASSERT(position <= m_buffer.size(), "Unreal",
+           "Seek past the end of package " << name);
+    this->position() = std::min(position, m_buffer.size());
+  }
+
+  void skip(std::size_t size) { seek(tell() + size); }
 
-  operator std::istream &() { return m_input; }
+  // Skips serialized array of `element_size` byte elements.
+  void skip_array(std::size_t element_size);
+
+  auto size() const -> std::size_t { return m_buffer.size(); }
 
   auto object_name(Index index) const -> Name;
 
+  // Thread-safe export lookups, index is built on first use.
+  auto find_export(std::string_view object_name, std::string_view class_name)
+      -> ObjectExport *;
+  auto class_exports(std::string_view class_name)
+      -> const std::vector<ObjectExport *> &;
+
   auto operator>>(PackageHeader &header) -> Archive &;
   auto operator>>(GUID &guid) -> Archive &;
   auto operator>>(GenerationInfo &generation) -> Archive &;
@@ -141,7 +219,39 @@ public:
       -> std::ostream &;
 
 private:
-  std::stringstream m_input;
+  struct ExportKey {
+    std::string_view object_name;
+    std::string_view class_name;
+
+    auto operator==(const ExportKey &other) const -> bool = default;
+  };
+
+  struct ExportKeyHash {
+    auto operator()(const ExportKey &key) const -> std::size_t {
+      const std::hash<std::string_view> hash;
+      return hash(key.object_name) ^ (hash(key.class_name) << 1);
+    }
+  };
+
+  std::vector<std::uint8_t> m_buffer;
+  std::size_t m_position = 0;
+
+  static inline thread_local Cursor *m_cursor = nullptr;
+
+  std::unordered_map<ExportKey, ObjectExport *, ExportKeyHash>
+      m_exports_by_name;
+  std::unordered_map<std::string_view, std::vector<ObjectExport *>>
+      m_exports_by_class;
+  std::once_flag m_export_index_flag;
+
+  // Cursor position if current thread has one for this archive.
+  auto position() -> std::size_t & {
+    return m_cursor != nullptr && &m_cursor->m_archive == this
+               ? m_cursor->m_position
+               : m_position;
+  }
+
+  void build_export_index();
 };
 
 } // namespace unreal
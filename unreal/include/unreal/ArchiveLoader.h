@@ -1,12 +1,23 @@
 #pragma once
 
 #include "Archive.h"
+#include "LoadProfile.h"
 #include "NameTable.h"
 
+#include <utils/NonCopyable.h>
+#include <utils/ThreadPool.h>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
 #include <filesystem>
-#include <sstream>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <optional>
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 namespace unreal {
@@ -22,24 +33,110 @@ struct SearchConfig {
 
 class ArchiveLoader {
 public:
+  // Archives loaded by the current thread while pin is alive are kept in
+  // cache. Nested pins of the same loader are no-op. Pin with `shared` pin
+  // adds loaded archives to it instead, e.g. in worker threads.
+  class Pin : public utils::NonCopyable {
+  public:
+    explicit Pin(const ArchiveLoader &archive_loader, Pin *shared = nullptr);
+    ~Pin();
+
+  private:
+    const ArchiveLoader &m_archive_loader;
+    Pin *m_previous;
+    bool m_current;
+    bool m_active;
+    std::unordered_set<std::string> m_names;
+
+    friend class ArchiveLoader;
+  };
+
+  // Unpinned archives are evicted in LRU order when cache exceeds
+  // `cache_budget` bytes of package data after a load or unpin, zero
+  // disables eviction.
   explicit ArchiveLoader(const std::filesystem::path &root_path,
-                         const std::vector<SearchConfig> &configs)
-      : m_root_path{root_path}, m_configs{configs} {}
+                         const std::vector<SearchConfig> &configs,
+                         LoadProfile profile = LoadProfile::Full,
+                         std::size_t cache_budget = 0)
+      : m_root_path{root_path}, m_configs{configs}, m_profile{profile},
+        m_cache_budget{cache_budget}, m_prefetch_cancelled{false} {}
+
+  ~ArchiveLoader();
+
+  // Thread-safe. Concurrent requests for the same package wait for the
+  // first one to load it. Evicted packages are loaded again.
+  //
+  // Packages imported by the loaded one are prefetched in background if
+  // `prefetch` is set.
+  auto load_archive(const std::string &name, bool prefetch = true) const
+      -> Archive *;
+
+  // Same as load_archive, but `importer` is evicted together with the loaded
+  // archive, because its objects reference objects of the loaded one.
+  auto load_imported_archive(const std::string &name,
+                             const Archive &importer) const -> Archive *;
+
+  // Loads packages in parallel, result is in the same order as names.
+  // Archives are kept only while the caller holds a pin.
+  auto load_archives(const std::vector<std::string> &names,
+                     bool prefetch = true) const -> std::vector<Archive *>;
+
+  auto pin(Pin *shared = nullptr) const -> Pin { return Pin{*this, shared}; }
 
-  auto load_archive(const std::string &name) const -> Archive *;
+  // Active pin of the current thread, null if there is none.
+  auto current_pin() const -> Pin *;
+
+  // Returns empty path if package file doesn't exist.
+  auto find_path(const std::string &name) const -> std::filesystem::path;
+
+  auto profile() const -> LoadProfile { return m_profile; }
 
 private:
+  struct CachedArchive {
+    std::shared_future<std::unique_ptr<Archive>> archive;
+    std::size_t pin_count = 0;
+    std::uint64_t last_use = 0;
+    bool prefetched = false;
+
+    // Archives importing objects from this one.
+    std::unordered_set<std::string> importers;
+  };
+
   const std::filesystem::path m_root_path;
   const std::vector<SearchConfig> m_configs;
+  const LoadProfile m_profile;
+  const std::size_t m_cache_budget;
 
-  mutable std::unordered_map<std::string, Archive> m_archives;
+  mutable std::mutex m_mutex;
+  mutable std::unordered_map<std::string, CachedArchive> m_archives;
+  mutable std::uint64_t m_use_counter = 0;
 
-  auto load_and_cache_archive(const std::string &name,
-                              const std::filesystem::path &path) const
-      -> Archive *;
+  std::atomic_bool m_prefetch_cancelled;
+
+  // Destroyed first, prefetch tasks use the cache.
+  mutable utils::ThreadPool m_prefetch_pool;
+
+  auto cache_archive(const std::string &name, const Archive *importer,
+                     bool prefetch) const -> Archive *;
+  void prefetch_imports(const Archive &archive) const;
+  void unpin(const std::unordered_set<std::string> &names) const;
+
+  // Must be called with locked mutex. Evicted archives are moved to
+  // `evicted` to be destroyed after unlocking. `keep` isn't evicted.
+  void evict(
+      std::vector<std::shared_future<std::unique_ptr<Archive>>> &evicted,
+      const std::string *keep = nullptr) const;
+  auto eviction_group(const std::string &name) const
+      -> std::optional<std::unordered_set<std::string>>;
+
+  auto find_and_load_archive(const std::string &name) const
+      -> std::unique_ptr<Archive>;
+  auto load_archive(const std::string &name,
+                    const std::filesystem::path &path) const
+      -> std::unique_ptr<Archive>;
 
   void dump_decrypted(const std::filesystem::path &path,
-                      const std::stringstream &decrypted) const;
+                      const std::vector<std::uint8_t> &decrypted) const;
 };
 
 } // namespace unreal
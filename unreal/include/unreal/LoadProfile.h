@@ -0,0 +1,15 @@
+#pragma once
+
+namespace unreal {
+
+enum class LoadProfile {
+  // Everything, including data needed only for rendering.
+  Full,
+
+  // Only data needed for collision geometry. Materials aren't deserialized,
+  // textures other than terrain heightmaps have no mips and static meshes
+  // have no color, UV and wireframe streams.
+  CollisionOnly,
+};
+
+} // namespace unreal
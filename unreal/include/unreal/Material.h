@@ -7,7 +7,10 @@
 #include "Primitives.h"
 #include "Property.h"
 
+#include <cstddef>
 #include <cstdint>
+#include <cstring>
+#include <span>
 #include <vector>
 
 namespace unreal {
@@ -93,7 +96,8 @@ public:
   std::int32_t u_size, v_size;   // Size, must be power of 2.
   std::int32_t u_clamp, v_clamp; // Clamped width, must be <= size.
 
-  explicit BitmapMaterial(Archive &archive) : RenderedMaterial{archive} {}
+  explicit BitmapMaterial(Archive &archive)
+      : RenderedMaterial{archive}, format{TEXF_P8} {}
 
   virtual auto set_property(const Property &property) -> bool override;
 };
@@ -107,15 +111,13 @@ public:
   virtual void deserialize() override;
 };
 
+// Mip data isn't copied, only its location in the package buffer is kept.
 struct Mipmap {
-  std::int32_t unknown; // ??? Pointer to data, valid only when locked.
-  std::vector<std::uint8_t> data;
-  std::int32_t u_size, v_size;    // Power of two tile dimensions.
-  std::int8_t u_bits, v_bits;     // Power of two tile bits.
-
-  template <typename T> auto as() const -> const T * {
-    return reinterpret_cast<const T *>(data.data());
-  }
+  std::int32_t unknown;        // ??? Pointer to data, valid only when locked.
+  std::size_t data_offset;     // Data position in package buffer.
+  std::size_t data_size;       // Data size in bytes.
+  std::int32_t u_size, v_size; // Power of two tile dimensions.
+  std::int8_t u_bits, v_bits;  // Power of two tile bits.
 
   friend auto operator>>(Archive &archive, Mipmap &mipmap) -> Archive &;
 };
@@ -186,6 +188,22 @@ public:
 
   virtual void deserialize() override;
   virtual auto set_property(const Property &property) -> bool override;
+
+  // Mip level data without copying, valid while package is loaded.
+  auto mip_data(std::size_t level) const -> std::span<const std::uint8_t>;
+
+  // Copies mip level data as `T` elements.
+  template <typename T>
+  auto load_mip(std::size_t level) const -> std::vector<T> {
+    const auto data = mip_data(level);
+    std::vector<T> elements(data.size() / sizeof(T));
+    std::memcpy(elements.data(), data.data(), elements.size() * sizeof(T));
+    return elements;
+  }
+
+  // Largest mip level fitting into `max_size` in both dimensions or the
+  // smallest one.
+  auto mip_level(std::int32_t max_size) const -> std::size_t;
 };
 
 enum OutputBlending {
@@ -1,15 +1,45 @@
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
 #include <string_view>
 
 namespace unreal {
 
+using NameId = std::uint64_t;
+
+// FNV-1a, stable between runs, so it can be used in switch cases.
+constexpr auto name_id(std::string_view string) -> NameId {
+  NameId id = 14695981039346656037ull;
+
+  for (const auto c : string) {
+    id ^= static_cast<std::uint8_t>(c);
+    id *= 1099511628211ull;
+  }
+
+  return id;
+}
+
+constexpr auto operator""_name(const char *data, std::size_t length)
+    -> NameId {
+
+  return name_id({data, length});
+}
+
 struct Name : public std::string_view {
   static constexpr auto NONE = "None";
 
-  Name() : std::string_view{} {}
+  // Unique within the name table.
+  NameId id;
+
+  Name() : std::string_view{}, id{name_id({})} {}
   explicit Name(const char *data, std::string_view::size_type length)
-      : std::string_view{data, length} {}
+      : std::string_view{data, length}, id{name_id(*this)} {}
+
+  auto is_none() const -> bool { return id == NONE_ID; }
+
+private:
+  static constexpr auto NONE_ID = name_id(NONE);
 };
 
 } // namespace unreal
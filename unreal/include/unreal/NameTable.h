@@ -4,26 +4,27 @@
 
 #include <utils/NonCopyable.h>
 
+#include <mutex>
 #include <string>
-#include <unordered_set>
-#include <utility>
+#include <string_view>
+#include <unordered_map>
 
 namespace unreal {
 
+// Global table of names shared by all archives. Names are never removed, so
+// views to them are valid until exit.
 class NameTable : public utils::NonCopyable {
 public:
-  NameTable() {}
-  NameTable(NameTable &&other) : m_names{std::move(other.m_names)} {}
-
-  auto name(const std::string &string) -> Name {
-    const auto name = m_names.insert(string).first;
-    return Name{name->data(), name->length()};
-  }
+  static auto instance() -> NameTable &;
 
+  auto name(std::string_view string) -> Name;
   auto none_name() -> Name { return name(Name::NONE); }
 
 private:
-  std::unordered_set<std::string> m_names;
+  std::mutex m_mutex;
+  std::unordered_map<NameId, std::string> m_names;
+
+  NameTable() {}
 };
 
 } // namespace unreal
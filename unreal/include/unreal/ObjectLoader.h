@@ -2,7 +2,9 @@
 
 #include "Index.h"
 
+#include <cstddef>
 #include <memory>
+#include <mutex>
 #include <ostream>
 #include <string>
 #include <utility>
@@ -36,8 +38,19 @@ private:
   Archive &m_archive;
   const ArchiveLoader &m_archive_loader;
 
+  // Exports of large classes are deserialized in parallel.
+  static constexpr std::size_t PARALLEL_EXPORT_THRESHOLD = 64;
+
+  mutable std::mutex m_mutex;
+
+  auto export_objects(const std::vector<ObjectExport *> &object_exports) const
+      -> std::vector<std::shared_ptr<Object>>;
+
+  // Thread-safe, object is created on first request.
   auto export_object(ObjectExport &object_export) const
       -> std::shared_ptr<Object>;
+  auto create_object(const ObjectExport &object_export) const
+      -> std::shared_ptr<Object>;
 };
 
 #include "Archive.h"
@@ -47,11 +60,10 @@ void ObjectLoader::load_objects(
     const std::string &class_name,
     std::vector<std::shared_ptr<T>> &objects) const {
 
-  for (auto &object_export : m_archive.export_map) {
-    if (object_export.class_name == class_name) {
-      objects.push_back(
-          std::dynamic_pointer_cast<T>(export_object(object_export)));
-    }
+  for (const auto &object :
+       export_objects(m_archive.class_exports(class_name))) {
+
+    objects.push_back(std::dynamic_pointer_cast<T>(object));
   }
 }
 
@@ -49,6 +49,9 @@ public:
 
   operator bool() const { return load_object<T>() != nullptr; }
 
+  // Loads object ahead of use, e.g. to deserialize objects in parallel.
+  void preload() const { load_object<T>(); }
+
 private:
   Index m_index;
   const ObjectLoader *m_object_loader;
@@ -29,6 +29,20 @@ public:
 
   auto name() const -> std::string { return std::string{m_archive.name}; }
 
+  // Names of packages this package imports objects from.
+  auto import_package_names() const -> std::vector<std::string> {
+    std::vector<std::string> names;
+
+    for (const auto &object_import : m_archive.import_map) {
+      if (object_import.package_index == 0 &&
+          object_import.class_name.id == "Package"_name) {
+        names.emplace_back(object_import.object_name);
+      }
+    }
+
+    return names;
+  }
+
   friend auto operator<<(std::ostream &output, const Package &package)
       -> std::ostream &;
 
@@ -1,8 +1,10 @@
 #pragma once
 
 #include "ArchiveLoader.h"
+#include "LoadProfile.h"
 #include "Package.h"
 
+#include <cstddef>
 #include <filesystem>
 #include <optional>
 #include <string>
@@ -13,10 +15,34 @@ namespace unreal {
 class PackageLoader {
 public:
   explicit PackageLoader(const std::filesystem::path &root_path,
-                         const std::vector<SearchConfig> &configs)
-      : m_archive_loader{root_path, configs} {}
+                         const std::vector<SearchConfig> &configs,
+                         LoadProfile profile = LoadProfile::Full,
+                         std::size_t cache_budget = 0)
+      : m_archive_loader{root_path, configs, profile, cache_budget} {}
 
-  auto load_package(const std::string &name) const -> std::optional<Package>;
+  // Imported packages are prefetched in background if `prefetch` is set.
+  auto load_package(const std::string &name, bool prefetch = true) const
+      -> std::optional<Package>;
+
+  // Loads packages in parallel. Packages are valid only while the caller
+  // holds a pin.
+  auto load_packages(const std::vector<std::string> &names,
+                     bool prefetch = true) const
+      -> std::vector<std::optional<Package>>;
+
+  // Packages loaded by the current thread aren't evicted while pin is alive.
+  // With `shared` pin they are kept by it instead.
+  auto pin(ArchiveLoader::Pin *shared = nullptr) const -> ArchiveLoader::Pin {
+    return m_archive_loader.pin(shared);
+  }
+
+  auto current_pin() const -> ArchiveLoader::Pin * {
+    return m_archive_loader.current_pin();
+  }
+
+  auto package_path(const std::string &name) const -> std::filesystem::path {
+    return m_archive_loader.find_path(name);
+  }
 
 private:
   ArchiveLoader m_archive_loader;
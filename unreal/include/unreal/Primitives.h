@@ -1,5 +1,7 @@
 #pragma once
 
+#include <utils/ExtractionHelpers.h>
+
 #include <cstdint>
 
 namespace unreal {
@@ -95,3 +97,15 @@ struct Quat {
 };
 
 } // namespace unreal
+
+template <>
+struct utils::BulkExtractable<unreal::Color>
+    : utils::PackedLittleEndian<unreal::Color, 4> {};
+
+template <>
+struct utils::BulkExtractable<unreal::Vector>
+    : utils::PackedLittleEndian<unreal::Vector, 12> {};
+
+template <>
+struct utils::BulkExtractable<unreal::Plane>
+    : utils::PackedLittleEndian<unreal::Plane, 16> {};
@@ -8,8 +8,10 @@
 #include <utils/Assert.h>
 
 #include <cstdint>
+#include <limits>
 #include <ostream>
-#include <unordered_map>
+#include <span>
+#include <string_view>
 #include <vector>
 
 namespace unreal {
@@ -32,6 +34,11 @@ enum class PropertyType : std::uint8_t {
   FixedArray = 15,
 };
 
+struct PropertyArena;
+
+// Property is a view: array data points to the archive buffer and struct
+// subproperties live in the extractor arena, both are valid only while the
+// property is visited.
 struct Property {
   Name name;
 
@@ -58,16 +65,38 @@ struct Property {
     Rotator rotator_value;
   };
 
-  std::vector<std::uint8_t> data_value;
-  std::vector<std::unordered_map<std::string, Property>> subproperties;
+  std::span<const std::uint8_t> data_value;
+
+  // Struct elements in the arena.
+  const PropertyArena *arena;
+  std::uint32_t first_element;
+  std::uint32_t element_count;
+
+  // Next property of the same struct element in the arena.
+  std::uint32_t next;
 
   auto bool_value() const -> bool;
 
-  auto subproperty(const std::string &name, std::size_t index = 0) const
-      -> Property;
+  auto subproperty(std::string_view name, std::size_t index = 0) const
+      -> const Property &;
 
   friend auto operator<<(std::ostream &output, const Property &property)
       -> std::ostream &;
 };
 
+// Storage for struct subproperties, one per thread, reused between objects to
+// not allocate per property.
+struct PropertyArena {
+  static constexpr auto NONE = std::numeric_limits<std::uint32_t>::max();
+
+  // Properties of struct elements, linked by `Property::next`.
+  std::vector<Property> properties;
+
+  // First property of each struct element.
+  std::vector<std::uint32_t> elements;
+
+  // Drops properties and elements added after the given counts.
+  void truncate(std::size_t property_count, std::size_t element_count);
+};
+
 } // namespace unreal
@@ -3,9 +3,6 @@
 #include "Property.h"
 
 #include <cstdint>
-#include <string>
-#include <unordered_map>
-#include <vector>
 
 namespace unreal {
 
@@ -15,15 +12,39 @@ class PropertyExtractor {
 public:
   explicit PropertyExtractor(Archive &archive) : m_archive{archive} {}
 
-  auto extract_properties() const -> std::vector<Property>;
+  // Calls visitor for each property of the current object. Properties are
+  // valid only during the call, see `Property`.
+  template <typename Visitor> void extract_properties(Visitor &&visitor) const {
+    // Arena is shared by the thread, subproperties are dropped after visiting.
+    auto &arena = thread_arena();
+    const auto property_count = arena.properties.size();
+    const auto element_count = arena.elements.size();
+
+    while (true) {
+      Property property{};
+      deserialize(property);
+
+      if (property.name.is_none()) {
+        break;
+      }
+
+      visitor(static_cast<const Property &>(property));
+    }
+
+    arena.truncate(property_count, element_count);
+  }
 
 private:
   Archive &m_archive;
 
+  static auto thread_arena() -> PropertyArena &;
+
   void deserialize(Property &property) const;
   auto extract_size(std::uint8_t size_type) const -> std::uint32_t;
-  auto extract_properties_map() const
-      -> std::unordered_map<std::string, Property>;
+
+  // Extracts struct elements into the arena, returns index of the first one.
+  auto extract_elements(std::uint32_t count) const -> std::uint32_t;
+  auto extract_element() const -> std::uint32_t;
 };
 
 } // namespace unreal
@@ -101,3 +101,11 @@ public:
 };
 
 } // namespace unreal
+
+template <>
+struct utils::BulkExtractable<unreal::StaticMeshVertex>
+    : utils::PackedLittleEndian<unreal::StaticMeshVertex, 24> {};
+
+template <>
+struct utils::BulkExtractable<unreal::StaticMeshUV>
+    : utils::PackedLittleEndian<unreal::StaticMeshUV, 8> {};
@@ -9,75 +9,77 @@ auto Actor::set_property(const Property &property) -> bool {
     return true;
   }
 
-  if (property.name == "Location") {
+  switch (property.name.id) {
+  case "Location"_name: {
     location = property.vector_value;
     return true;
   }
 
-  if (property.name == "Rotation") {
+  case "Rotation"_name: {
     rotation = property.rotator_value;
     return true;
   }
 
-  if (property.name == "DrawScale") {
+  case "DrawScale"_name: {
     draw_scale = property.float_value;
     return true;
   }
 
-  if (property.name == "DrawScale3D") {
+  case "DrawScale3D"_name: {
     draw_scale_3d = property.vector_value;
     return true;
   }
 
-  if (property.name == "StaticMesh") {
+  case "StaticMesh"_name: {
     static_mesh.from_property(property, archive);
     return true;
   }
 
-  if (property.name == "bDeleteMe") {
+  case "bDeleteMe"_name: {
     delete_me = property.bool_value();
     return true;
   }
 
-  if (property.name == "bHidden") {
+  case "bHidden"_name: {
     hidden = property.bool_value();
     return true;
   }
 
-  if (property.name == "bCollideActors") {
+  case "bCollideActors"_name: {
     collide_actors = property.bool_value();
     return true;
   }
 
-  if (property.name == "bBlockActors") {
+  case "bBlockActors"_name: {
     block_actors = property.bool_value();
     return true;
   }
 
-  if (property.name == "bBlockPlayers") {
+  case "bBlockPlayers"_name: {
     block_players = property.bool_value();
     return true;
   }
 
-  if (property.name == "PrePivot") {
+  case "PrePivot"_name: {
     pre_pivot = property.vector_value;
     return true;
   }
 
-  if (property.name == "bBlockNonZeroExtentTraces") {
+  case "bBlockNonZeroExtentTraces"_name: {
     block_non_zero_extent_traces = property.bool_value();
     return true;
   }
 
-  if (property.name == "bUseCylinderCollision") {
+  case "bUseCylinderCollision"_name: {
     use_cylinder_collision = property.bool_value();
     return true;
   }
 
-  if (property.name == "bWorldGeometry") {
+  case "bWorldGeometry"_name: {
     world_geometry = property.bool_value();
     return true;
   }
+  }
 
   return false;
 }
@@ -97,10 +99,12 @@ auto BrushActor::set_property(const Property &property) -> bool {
     return true;
   }
 
-  if (property.name == "Brush") {
+  switch (property.name.id) {
+  case "Brush"_name: {
     brush.from_property(property, archive);
     return true;
   }
+  }
 
   return false;
 }
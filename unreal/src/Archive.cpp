@@ -5,29 +5,30 @@
 
 namespace unreal {
 
-Archive::Archive(const std::string &name, std::stringstream input,
+Archive::Archive(const std::string &name, std::vector<std::uint8_t> buffer,
                  const ArchiveLoader &archive_loader)
     : object_loader{*this, archive_loader}, property_extractor{*this},
-      name{m_name_table.name(name)}, m_input{std::move(input)} {
+      name{NameTable::instance().name(name)},
+      profile{archive_loader.profile()}, m_buffer{std::move(buffer)} {
 
   *this >> header;
 
-  m_input.seekg(header.name_offset);
+  seek(header.name_offset);
   for (auto i = 0; i < header.name_count; ++i) {
     std::string name;
     std::uint32_t flags = 0;
     *this >> name >> flags;
-    name_map.emplace_back(m_name_table.name(name));
+    name_map.emplace_back(NameTable::instance().name(name));
   }
 
-  m_input.seekg(header.import_offset);
+  seek(header.import_offset);
   for (auto i = 0; i < header.import_count; ++i) {
     ObjectImport object_import{};
     *this >> object_import;
     import_map.push_back(object_import);
   }
 
-  m_input.seekg(header.export_offset);
+  seek(header.export_offset);
   for (auto i = 0; i < header.export_count; ++i) {
     ObjectExport object_export{};
     *this >> object_export;
@@ -48,7 +49,62 @@ auto Archive::object_name(Index index) const -> Name {
     return export_map[index - 1].object_name;
   }
 
-  return m_name_table.none_name();
+  return NameTable::instance().none_name();
+}
+
+auto Archive::find_export(std::string_view object_name,
+                          std::string_view class_name) -> ObjectExport * {
+  build_export_index();
+
+  const auto pair = m_exports_by_name.find({object_name, class_name});
+  return pair != m_exports_by_name.end() ? pair->second : nullptr;
+}
+
+auto Archive::class_exports(std::string_view class_name)
+    -> const std::vector<ObjectExport *> & {
+
+  static const std::vector<ObjectExport *> empty;
+
+  build_export_index();
+
+  const auto pair = m_exports_by_class.find(class_name);
+  return pair != m_exports_by_class.end() ? pair->second : empty;
+}
+
+void Archive::build_export_index() {
+  std::call_once(m_export_index_flag, [this] {
+    m_exports_by_name.reserve(export_map.size());
+
+    for (auto &object_export : export_map) {
+      // First export wins, as with linear search.
+      if (object_export.class_name.id != "Package"_name) {
+        m_exports_by_name.try_emplace(
+            {object_export.object_name, object_export.class_name},
+            &object_export);
+      }
+
+      m_exports_by_class[object_export.class_name].push_back(&object_export);
+    }
+  });
+}
+
+Archive::Cursor::Cursor(Archive &archive, std::size_t position)
+    : m_archive{archive}, m_position{position}, m_previous{m_cursor} {
+
+  ASSERT(position <= archive.size(), "Unreal",
+         "Cursor past the end of package " << archive.name);
+  m_position = std::min(position, archive.size());
+  m_cursor = this;
+}
+
+Archive::Cursor::~Cursor() { m_cursor = m_previous; }
+
+void Archive::skip_array(std::size_t element_size) {
+  Index size{};
+  *this >> size;
+
+  ASSERT(size >= 0, "Unreal", "Size can't be negative");
+  skip(static_cast<std::size_t>(std::max(size.value, 0)) * element_size);
 }
 
 auto Archive::operator>>(PackageHeader &header) -> Archive & {
@@ -93,15 +149,25 @@ auto Archive::operator>>(Name &name) -> Archive & {
   if (static_cast<std::size_t>(index) < name_map.size()) {
     name = name_map[index];
   } else {
-    name = m_name_table.none_name();
+    name = NameTable::instance().none_name();
   }
 
   return *this;
 }
 
 auto Archive::operator>>(Index &index) -> Archive & {
-  std::uint8_t byte = 0;
-  *this >> byte;
+  auto &position = this->position();
+
+  const auto next_byte = [this, &position]() -> std::uint8_t {
+    if (position < m_buffer.size()) {
+      return m_buffer[position++];
+    }
+
+    ASSERT(false, "Unreal", "Read past the end of package " << name);
+    return 0;
+  };
+
+  auto byte = next_byte();
 
   const auto negative = (byte & (1 << 7)) != 0;
   auto value = byte & 0x3f;
@@ -111,7 +177,7 @@ auto Archive::operator>>(Index &index) -> Archive & {
 
     do {
       auto data = 0;
-      *this >> byte;
+      byte = next_byte();
       data = byte & 0x7f;
       data <<= shift;
       value |= data;
@@ -152,12 +218,12 @@ auto Archive::operator>>(ObjectExport &object_export) -> Archive & {
 }
 
 auto Archive::operator>>(char &value) -> Archive & {
-  m_input >> value;
+  read(&value, sizeof(value));
   return *this;
 }
 
 auto Archive::operator>>(float &value) -> Archive & {
-  m_input.read(reinterpret_cast<char *>(&value), sizeof(value));
+  read(reinterpret_cast<char *>(&value), sizeof(value));
   return *this;
 }
 
@@ -217,8 +283,7 @@ auto Archive::operator>>(std::uint64_t &value) -> Archive & {
 }
 
 void Archive::dump(int line_count, int line_length) {
-  std::istream &input = *this;
-  const auto offset = input.tellg();
+  const auto offset = tell();
 
   std::cout << std::endl;
   std::cout << "Package: " << name << std::endl;
@@ -226,7 +291,7 @@ void Archive::dump(int line_count, int line_length) {
   std::cout << "License Version: " << header.license_version << std::endl;
   std::cout << "Offset: " << offset << std::endl;
 
-  utils::dump(input, line_count, line_length);
+  utils::dump(m_buffer, offset, line_count, line_length);
 }
 
 } // namespace unreal
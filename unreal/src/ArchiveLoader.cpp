@@ -7,48 +7,363 @@
 
 namespace unreal {
 
-auto ArchiveLoader::load_archive(const std::string &name) const -> Archive * {
-  const auto pair = m_archives.find(name);
+namespace {
 
-  if (pair != m_archives.end()) {
-    return &pair->second;
+thread_local ArchiveLoader::Pin *thread_pin = nullptr;
+
+} // namespace
+
+ArchiveLoader::Pin::Pin(const ArchiveLoader &archive_loader, Pin *shared)
+    : m_archive_loader{archive_loader}, m_previous{thread_pin},
+      m_current{shared != nullptr || archive_loader.current_pin() == nullptr},
+      m_active{shared == nullptr && m_current} {
+
+  if (m_current) {
+    thread_pin = shared != nullptr ? shared : this;
+  }
+}
+
+ArchiveLoader::Pin::~Pin() {
+  if (m_current) {
+    thread_pin = m_previous;
+  }
+
+  if (m_active) {
+    m_archive_loader.unpin(m_names);
+  }
+}
+
+ArchiveLoader::~ArchiveLoader() { m_prefetch_cancelled = true; }
+
+auto ArchiveLoader::current_pin() const -> Pin * {
+  return thread_pin != nullptr && &thread_pin->m_archive_loader == this
+             ? thread_pin
+             : nullptr;
+}
+
+auto ArchiveLoader::load_archive(const std::string &name, bool prefetch) const
+    -> Archive * {
+
+  return cache_archive(name, nullptr, prefetch);
+}
+
+auto ArchiveLoader::load_imported_archive(const std::string &name,
+                                          const Archive &importer) const
+    -> Archive * {
+
+  return cache_archive(name, &importer, false);
+}
+
+auto ArchiveLoader::cache_archive(const std::string &name,
+                                  const Archive *importer, bool prefetch) const
+    -> Archive * {
+
+  std::promise<std::unique_ptr<Archive>> promise;
+  std::shared_future<std::unique_ptr<Archive>> future;
+  auto loading = false;
+
+  {
+    std::lock_guard lock{m_mutex};
+    auto &cached = m_archives[name];
+
+    if (!cached.archive.valid()) {
+      cached.archive = promise.get_future().share();
+      loading = true;
+    }
+
+    cached.last_use = ++m_use_counter;
+
+    // Package could be loaded without prefetch before.
+    prefetch = prefetch && !cached.prefetched;
+    cached.prefetched = cached.prefetched || prefetch;
+
+    if (importer != nullptr) {
+      cached.importers.emplace(importer->name);
+    }
+
+    // Pin names are changed under the mutex, as shared pins are used by
+    // several threads.
+    auto *pin = current_pin();
+
+    if (pin != nullptr && pin->m_names.insert(name).second) {
+      cached.pin_count++;
+    }
+
+    future = cached.archive;
+  }
+
+  if (loading) {
+    try {
+      promise.set_value(find_and_load_archive(name));
+    } catch (...) {
+      // Failed load isn't cached, so the next load retries. Entry is kept
+      // without archive while pins count it.
+      {
+        std::lock_guard lock{m_mutex};
+        const auto cached = m_archives.find(name);
+
+        if (cached->second.pin_count == 0) {
+          m_archives.erase(cached);
+        } else {
+          cached->second.archive = {};
+        }
+      }
+
+      promise.set_exception(std::current_exception());
+      throw;
+    }
+
+    // Loads of unpinned archives (preload, prefetch) can exceed the budget
+    // too, the loaded archive itself is kept for the caller.
+    std::vector<std::shared_future<std::unique_ptr<Archive>>> evicted;
+    std::lock_guard lock{m_mutex};
+    evict(evicted, &name);
+  }
+
+  auto *archive = future.get().get();
+
+  if (prefetch && archive != nullptr) {
+    prefetch_imports(*archive);
+  }
+
+  return archive;
+}
+
+void ArchiveLoader::prefetch_imports(const Archive &archive) const {
+  for (const auto &object_import : archive.import_map) {
+    if (object_import.package_index != 0 ||
+        object_import.class_name.id != "Package"_name) {
+      continue;
+    }
+
+    std::string name{object_import.object_name};
+
+    {
+      std::lock_guard lock{m_mutex};
+
+      if (m_archives.contains(name)) {
+        continue;
+      }
+    }
+
+    // Script packages like Engine aren't available.
+    if (find_path(name).empty()) {
+      continue;
+    }
+
+    m_prefetch_pool.submit([this, name = std::move(name)] {
+      if (m_prefetch_cancelled) {
+        return;
+      }
+
+      try {
+        cache_archive(name, nullptr, false);
+      } catch (const std::exception &exception) {
+        utils::Log(utils::LOG_WARN, "Unreal")
+            << "Can't prefetch package " << name << ": " << exception.what()
+            << std::endl;
+      }
+    });
+  }
+}
+
+void ArchiveLoader::unpin(const std::unordered_set<std::string> &names) const {
+  // Destroyed after unlocking.
+  std::vector<std::shared_future<std::unique_ptr<Archive>>> evicted;
+
+  {
+    std::lock_guard lock{m_mutex};
+
+    for (const auto &name : names) {
+      const auto cached = m_archives.find(name);
+
+      if (cached != m_archives.end()) {
+        cached->second.pin_count--;
+      }
+    }
+
+    evict(evicted);
   }
+}
+
+auto ArchiveLoader::load_archives(const std::vector<std::string> &names,
+                                  bool prefetch) const
+    -> std::vector<Archive *> {
+
+  utils::ThreadPool pool{std::min<std::size_t>(
+      names.size(), std::max(1u, std::thread::hardware_concurrency()))};
+
+  // Archives loaded by workers are kept by the caller's pin.
+  auto *caller_pin = current_pin();
+
+  std::vector<std::future<Archive *>> futures;
+  futures.reserve(names.size());
+
+  for (const auto &name : names) {
+    futures.push_back(pool.submit([this, &name, prefetch, caller_pin] {
+      const auto pin = this->pin(caller_pin);
+      return load_archive(name, prefetch);
+    }));
+  }
+
+  std::vector<Archive *> archives;
+  archives.reserve(names.size());
+
+  for (auto &future : futures) {
+    archives.push_back(future.get());
+  }
+
+  return archives;
+}
+
+void ArchiveLoader::evict(
+    std::vector<std::shared_future<std::unique_ptr<Archive>>> &evicted,
+    const std::string *keep) const {
+
+  if (m_cache_budget == 0) {
+    return;
+  }
+
+  const auto loaded_size = [](const CachedArchive &cached) -> std::size_t {
+    if (!cached.archive.valid() ||
+        cached.archive.wait_for(std::chrono::seconds{0}) !=
+            std::future_status::ready ||
+        cached.archive.get() == nullptr) {
+      return 0;
+    }
+
+    return cached.archive.get()->size();
+  };
+
+  std::size_t cache_size = 0;
+
+  for (const auto &[name, cached] : m_archives) {
+    cache_size += loaded_size(cached);
+  }
+
+  while (cache_size > m_cache_budget) {
+    // Least recently used archive which can be evicted with its importers.
+    std::unordered_set<std::string> group;
+    auto group_use = std::numeric_limits<std::uint64_t>::max();
+
+    for (const auto &[name, cached] : m_archives) {
+      if (cached.last_use >= group_use || loaded_size(cached) == 0) {
+        continue;
+      }
+
+      auto candidate = eviction_group(name);
+
+      if (candidate.has_value() &&
+          (keep == nullptr || !candidate->contains(*keep))) {
+        group = std::move(candidate.value());
+        group_use = cached.last_use;
+      }
+    }
+
+    if (group.empty()) {
+      break;
+    }
+
+    for (const auto &name : group) {
+      const auto cached = m_archives.find(name);
+
+      if (cached == m_archives.end()) {
+        continue;
+      }
+
+      cache_size -= loaded_size(cached->second);
+      evicted.push_back(std::move(cached->second.archive));
+      m_archives.erase(cached);
+
+      utils::Log(utils::LOG_INFO, "Unreal")
+          << "Package evicted: " << name << std::endl;
+    }
+
+    for (auto &[name, cached] : m_archives) {
+      for (const auto &evicted_name : group) {
+        cached.importers.erase(evicted_name);
+      }
+    }
+  }
+}
+
+auto ArchiveLoader::eviction_group(const std::string &name) const
+    -> std::optional<std::unordered_set<std::string>> {
+
+  std::unordered_set<std::string> group{name};
+  std::vector<std::string> queue{name};
+
+  while (!queue.empty()) {
+    const auto cached = m_archives.find(queue.back());
+    queue.pop_back();
+
+    if (cached == m_archives.end()) {
+      continue;
+    }
+
+    // Archive in use or still loading. Entries of failed loads are dropped.
+    if (cached->second.pin_count != 0 ||
+        (cached->second.archive.valid() &&
+         cached->second.archive.wait_for(std::chrono::seconds{0}) !=
+             std::future_status::ready)) {
+
+      return {};
+    }
+
+    for (const auto &importer : cached->second.importers) {
+      if (group.insert(importer).second) {
+        queue.push_back(importer);
+      }
+    }
+  }
+
+  return group;
+}
+
+auto ArchiveLoader::find_and_load_archive(const std::string &name) const
+    -> std::unique_ptr<Archive> {
 
   utils::Log(utils::LOG_INFO, "Unreal")
       << "Loading package: " << name << std::endl;
 
+  const auto path = find_path(name);
+
+  if (path.empty()) {
+    utils::Log(utils::LOG_WARN, "Unreal")
+        << "Can't find package: " << name << std::endl;
+    return nullptr;
+  }
+
+  return load_archive(name, path);
+}
+
+auto ArchiveLoader::find_path(const std::string &name) const
+    -> std::filesystem::path {
+
   for (const auto &config : m_configs) {
     const auto path =
         m_root_path / config.directory / (name + "." + config.extension);
 
-    if (!std::filesystem::exists(path)) {
-      continue;
+    if (std::filesystem::exists(path)) {
+      return path;
     }
-
-    return load_and_cache_archive(name, path);
   }
 
-  utils::Log(utils::LOG_WARN, "Unreal")
-      << "Can't find package: " << name << std::endl;
-
-  return nullptr;
+  return {};
 }
 
-auto ArchiveLoader::load_and_cache_archive(
-    const std::string &name, const std::filesystem::path &path) const
-    -> Archive * {
+auto ArchiveLoader::load_archive(const std::string &name,
+                                 const std::filesystem::path &path) const
+    -> std::unique_ptr<Archive> {
 
-  std::stringstream decrypted;
   Decryptor decryptor;
-  decryptor.decrypt(path, decrypted);
+  auto decrypted = decryptor.decrypt(path);
 
   if (utils::Log::level > utils::LOG_INFO) {
     dump_decrypted(path, decrypted);
   }
 
-  const auto inserted =
-      m_archives.try_emplace(name, name, std::move(decrypted), *this);
-  auto *archive = &inserted.first->second;
+  auto archive = std::make_unique<Archive>(name, std::move(decrypted), *this);
 
   utils::Log(utils::LOG_INFO, "Unreal")
       << "Package loaded: " << name
@@ -58,17 +373,19 @@ auto ArchiveLoader::load_and_cache_archive(
   return archive;
 }
 
-void ArchiveLoader::dump_decrypted(const std::filesystem::path &path,
-                                   const std::stringstream &decrypted) const {
+void ArchiveLoader::dump_decrypted(
+    const std::filesystem::path &path,
+    const std::vector<std::uint8_t> &decrypted) const {
 
   auto output_path = path.filename();
   output_path += ".dec";
-  std::ofstream output{output_path};
+  std::ofstream output{output_path, std::ios::binary};
 
   utils::Log(utils::LOG_DEBUG, "Unreal")
       << "Decrypted package: " << output_path << std::endl;
 
-  output << decrypted.str();
+  output.write(reinterpret_cast<const char *>(decrypted.data()),
+               static_cast<std::streamsize>(decrypted.size()));
 }
 
 } // namespace unreal
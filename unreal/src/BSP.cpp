@@ -18,7 +18,7 @@ auto operator>>(Archive &archive, BSPNode &node) -> Archive & {
       node.vertex_count >> node.leaf[0] >> node.leaf[1];
 
   // Skip 4 pointers (4*4 bytes) to projected textures.
-  static_cast<std::istream &>(archive).seekg(12, std::ios::cur);
+  archive.skip(12);
 
   return archive;
 }
@@ -2,81 +2,160 @@
 
 #include "Decryptor.h"
 
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+#define DECRYPTOR_SSE2
+#include <emmintrin.h>
+#endif
+
 namespace unreal {
 
-static constexpr std::streamsize LINEAGE_SIZE = 22;
-static constexpr std::streamsize VERSION_SIZE = 6;
+static constexpr std::size_t LINEAGE_SIZE = 22;
+static constexpr std::size_t VERSION_SIZE = 6;
+static constexpr std::size_t HEADER_SIZE = LINEAGE_SIZE + VERSION_SIZE;
+
+// Smaller packages are decrypted in the calling thread.
+static constexpr std::size_t PARALLEL_CHUNK_SIZE = 8 * 1024 * 1024;
 
 // "Lineage2Ver" string
-static constexpr std::array<char, LINEAGE_SIZE> LINEAGE_HEADER = {
+static constexpr std::array<std::uint8_t, LINEAGE_SIZE> LINEAGE_HEADER = {
     0x4c, 0x00, 0x69, 0x00, 0x6e, 0x00, 0x65, 0x00, 0x61, 0x00, 0x67,
     0x00, 0x65, 0x00, 0x32, 0x00, 0x56, 0x00, 0x65, 0x00, 0x72, 0x00};
 
-void Decryptor::decrypt(const std::filesystem::path &path,
-                        std::ostream &output) {
+static void xor_bytes(const std::uint8_t *input, std::uint8_t *output,
+                      std::size_t size, std::uint8_t key) {
+
+  std::size_t i = 0;
+
+#ifdef DECRYPTOR_SSE2
+  const auto key_vector = _mm_set1_epi8(static_cast<char>(key));
+
+  for (; i + 64 <= size; i += 64) {
+    const auto *source = reinterpret_cast<const __m128i *>(input + i);
+    auto *destination = reinterpret_cast<__m128i *>(output + i);
+
+    const auto a = _mm_loadu_si128(source + 0);
+    const auto b = _mm_loadu_si128(source + 1);
+    const auto c = _mm_loadu_si128(source + 2);
+    const auto d = _mm_loadu_si128(source + 3);
+
+    _mm_storeu_si128(destination + 0, _mm_xor_si128(a, key_vector));
+    _mm_storeu_si128(destination + 1, _mm_xor_si128(b, key_vector));
+    _mm_storeu_si128(destination + 2, _mm_xor_si128(c, key_vector));
+    _mm_storeu_si128(destination + 3, _mm_xor_si128(d, key_vector));
+  }
+#endif
+
+  for (; i < size; ++i) {
+    output[i] = input[i] ^ key;
+  }
+}
+
+auto Decryptor::decrypt(const std::filesystem::path &path)
+    -> std::vector<std::uint8_t> {
 
-  std::ifstream input{path, std::ios::binary};
-  const auto version = extract_version(input);
+  const utils::MappedFile file{path};
+
+  if (!file.is_open()) {
+    ASSERT(false, "Unreal", "Can't open package: " << path);
+    return {};
+  }
+
+  const auto version = extract_version(file.data(), file.size());
 
   if (!version.has_value()) {
     ASSERT(false, "Unreal", "Can't detect Lineage 2 encryption version");
-    return;
+    return {};
   }
 
+  const auto *input = file.data() + HEADER_SIZE;
+  const auto size = file.size() - HEADER_SIZE;
+
   switch (version.value()) {
   case 111: {
-    decrypt_v111(input, output);
-  } break;
+    return decrypt_v111(input, size);
+  }
   case 121: {
-    decrypt_v121(input, output, path);
-  } break;
+    return decrypt_v121(input, size, path);
+  }
   default: {
     ASSERT(false, "Unreal",
            "Unsupported Linage 2 encryption version: " << version.value());
+    return {};
   }
   }
 }
 
-auto Decryptor::extract_version(std::istream &input) -> std::optional<int> {
-  std::array<char, LINEAGE_SIZE> lineage_buffer{};
-  std::array<char, VERSION_SIZE> version_buffer{};
-  input.read(lineage_buffer.data(), LINEAGE_SIZE);
-  input.read(version_buffer.data(), VERSION_SIZE);
+auto Decryptor::extract_version(const std::uint8_t *input, std::size_t size)
+    -> std::optional<int> {
 
-  if (lineage_buffer != LINEAGE_HEADER) {
+  if (size < HEADER_SIZE ||
+      !std::equal(LINEAGE_HEADER.begin(), LINEAGE_HEADER.end(), input)) {
     return {};
   }
 
-  std::string version_string;
-  version_string += version_buffer[0];
-  version_string += version_buffer[2];
-  version_string += version_buffer[4];
-
-  std::istringstream version_stream(version_string);
+  // UTF-16 digits.
+  const auto *version_buffer = input + LINEAGE_SIZE;
   auto version = 0;
-  version_stream >> version;
+
+  for (std::size_t i = 0; i < VERSION_SIZE; i += 2) {
+    if (std::isdigit(version_buffer[i]) == 0) {
+      return {};
+    }
+
+    version = version * 10 + (version_buffer[i] - '0');
+  }
 
   return version;
 }
 
-void Decryptor::decrypt_xor(std::istream &input, std::ostream &output,
-                            int key) {
+auto Decryptor::decrypt_xor(const std::uint8_t *input, std::size_t size,
+                            std::uint8_t key) -> std::vector<std::uint8_t> {
 
-  std::istreambuf_iterator input_iterator{input};
-  std::ostreambuf_iterator output_iterator{output};
-  std::istreambuf_iterator<char> end;
+  std::vector<std::uint8_t> output(size);
 
-  for (auto it = input_iterator; it != end; ++it) {
-    *(output_iterator++) = *it ^ key;
+  // Key doesn't depend on position, so chunks are independent.
+  const auto chunk_count =
+      std::min<std::size_t>(size / PARALLEL_CHUNK_SIZE,
+                            std::max(std::thread::hardware_concurrency(), 1u));
+
+  if (chunk_count <= 1) {
+    xor_bytes(input, output.data(), size, key);
+    return output;
   }
+
+  // Shared by all callers, so packages decrypted concurrently by archive
+  // loading and prefetch don't start a thread per chunk each.
+  static utils::ThreadPool pool;
+
+  const auto chunk_size = (size + chunk_count - 1) / chunk_count;
+  std::vector<std::future<void>> chunks;
+
+  for (std::size_t offset = chunk_size; offset < size; offset += chunk_size) {
+    chunks.push_back(
+        pool.submit([input, &output, size, key, offset, chunk_size] {
+          xor_bytes(input + offset, output.data() + offset,
+                    std::min(chunk_size, size - offset), key);
+        }));
+  }
+
+  xor_bytes(input, output.data(), chunk_size, key);
+
+  for (auto &chunk : chunks) {
+    chunk.get();
+  }
+
+  return output;
 }
 
-void Decryptor::decrypt_v111(std::istream &input, std::ostream &output) {
-  decrypt_xor(input, output, 0xac);
+auto Decryptor::decrypt_v111(const std::uint8_t *input, std::size_t size)
+    -> std::vector<std::uint8_t> {
+
+  return decrypt_xor(input, size, 0xac);
 }
 
-void Decryptor::decrypt_v121(std::istream &input, std::ostream &output,
-                             const std::filesystem::path &path) {
+auto Decryptor::decrypt_v121(const std::uint8_t *input, std::size_t size,
+                             const std::filesystem::path &path)
+    -> std::vector<std::uint8_t> {
 
   const auto filename = path.filename().string();
   auto key = 0;
@@ -85,7 +164,7 @@ void Decryptor::decrypt_v121(std::istream &input, std::ostream &output,
     key += std::tolower(character);
   }
 
-  decrypt_xor(input, output, key);
+  return decrypt_xor(input, size, static_cast<std::uint8_t>(key & 0xff));
 }
 
 } // namespace unreal
@@ -1,21 +1,28 @@
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
 #include <filesystem>
-#include <iostream>
 #include <optional>
+#include <vector>
 
 namespace unreal {
 
 class Decryptor {
 public:
-  void decrypt(const std::filesystem::path &path, std::ostream &output);
+  // Returns empty buffer on error.
+  auto decrypt(const std::filesystem::path &path) -> std::vector<std::uint8_t>;
 
 private:
-  auto extract_version(std::istream &input) -> std::optional<int>;
-  void decrypt_xor(std::istream &input, std::ostream &output, int key);
-  void decrypt_v111(std::istream &input, std::ostream &output);
-  void decrypt_v121(std::istream &input, std::ostream &output,
-                    const std::filesystem::path &path);
+  auto extract_version(const std::uint8_t *input, std::size_t size)
+      -> std::optional<int>;
+  auto decrypt_xor(const std::uint8_t *input, std::size_t size,
+                   std::uint8_t key) -> std::vector<std::uint8_t>;
+  auto decrypt_v111(const std::uint8_t *input, std::size_t size)
+      -> std::vector<std::uint8_t>;
+  auto decrypt_v121(const std::uint8_t *input, std::size_t size,
+                    const std::filesystem::path &path)
+      -> std::vector<std::uint8_t>;
 };
 
 } // namespace unreal
@@ -11,10 +11,12 @@ auto Modifier::set_property(const Property &property) -> bool {
     return true;
   }
 
-  if (property.name == "Material") {
+  switch (property.name.id) {
+  case "Material"_name: {
     material.from_property(property, archive);
     return true;
   }
+  }
 
   return false;
 }
@@ -24,40 +26,42 @@ auto FinalBlend::set_property(const Property &property) -> bool {
     return true;
   }
 
-  if (property.name == "FrameBufferBlending") {
+  switch (property.name.id) {
+  case "FrameBufferBlending"_name: {
     fb_blending = static_cast<FrameBufferBlending>(property.uint8_t_value);
     return true;
   }
 
-  if (property.name == "ZWrite") {
+  case "ZWrite"_name: {
     z_write = property.bool_value();
     return true;
   }
 
-  if (property.name == "ZTest") {
+  case "ZTest"_name: {
     z_test = property.bool_value();
     return true;
   }
 
-  if (property.name == "AlphaTest") {
+  case "AlphaTest"_name: {
     alpha_test = property.bool_value();
     return true;
   }
 
-  if (property.name == "TwoSided") {
+  case "TwoSided"_name: {
     two_sided = property.bool_value();
     return true;
   }
 
-  if (property.name == "AlphaRef") {
+  case "AlphaRef"_name: {
     alpha_ref = property.uint8_t_value;
     return true;
   }
 
-  if (property.name == "TreatAsTwoSided") {
+  case "TreatAsTwoSided"_name: {
     treat_as_two_sided = property.bool_value();
     return true;
   }
+  }
 
   return false;
 }
@@ -67,40 +71,42 @@ auto BitmapMaterial::set_property(const Property &property) -> bool {
     return true;
   }
 
-  if (property.name == "Format") {
+  switch (property.name.id) {
+  case "Format"_name: {
     format = static_cast<TextureFormat>(property.uint8_t_value);
     return true;
   }
 
-  if (property.name == "UBits") {
+  case "UBits"_name: {
     u_bits = property.uint8_t_value;
     return true;
   }
 
-  if (property.name == "VBits") {
+  case "VBits"_name: {
     v_bits = property.uint8_t_value;
     return true;
   }
 
-  if (property.name == "USize") {
+  case "USize"_name: {
     u_size = property.int32_t_value;
     return true;
   }
 
-  if (property.name == "VSize") {
+  case "VSize"_name: {
     v_size = property.int32_t_value;
     return true;
   }
 
-  if (property.name == "UClamp") {
+  case "UClamp"_name: {
     u_clamp = property.int32_t_value;
     return true;
   }
 
-  if (property.name == "VClamp") {
+  case "VClamp"_name: {
     v_clamp = property.int32_t_value;
     return true;
   }
+  }
 
   return false;
 }
@@ -111,34 +117,72 @@ void Palette::deserialize() {
 }
 
 auto operator>>(Archive &archive, Mipmap &mipmap) -> Archive & {
-  archive >> mipmap.unknown >> mipmap.data >> mipmap.u_size >> mipmap.v_size >>
-      mipmap.u_bits >> mipmap.v_bits;
+  Index size;
+  archive >> mipmap.unknown >> size;
+  ASSERT(size >= 0, "Unreal", "Negative mip size in package " << archive.name);
+
+  mipmap.data_offset = archive.tell();
+  mipmap.data_size = std::max(static_cast<std::int32_t>(size), 0);
+  archive.skip(mipmap.data_size);
+
+  archive >> mipmap.u_size >> mipmap.v_size >> mipmap.u_bits >> mipmap.v_bits;
   return archive;
 }
 
 void Texture::deserialize() {
   BitmapMaterial::deserialize();
 
+  // Terrain heightmaps are the only textures used for collision.
+  if (archive.profile == LoadProfile::CollisionOnly && format != TEXF_G16) {
+    return;
+  }
+
   MaterialDeserializer deserializer;
   deserializer.deserialize(archive);
 
   archive >> mips;
 }
 
+auto Texture::mip_data(std::size_t level) const
+    -> std::span<const std::uint8_t> {
+
+  ASSERT(level < mips.size(), "Unreal",
+         "Texture " << name << " has no mip level " << level);
+
+  if (level >= mips.size()) {
+    return {};
+  }
+
+  const auto &mip = mips[level];
+  return archive.view(mip.data_offset, mip.data_size);
+}
+
+auto Texture::mip_level(std::int32_t max_size) const -> std::size_t {
+  for (std::size_t level = 0; level < mips.size(); ++level) {
+    if (mips[level].u_size <= max_size && mips[level].v_size <= max_size) {
+      return level;
+    }
+  }
+
+  return mips.empty() ? 0 : mips.size() - 1;
+}
+
 auto Texture::set_property(const Property &property) -> bool {
   if (BitmapMaterial::set_property(property)) {
     return true;
   }
 
-  if (property.name == "bAlphaTexture") {
+  switch (property.name.id) {
+  case "bAlphaTexture"_name: {
     alpha_texture = property.bool_value();
     return true;
   }
 
-  if (property.name == "bTwoSided") {
+  case "bTwoSided"_name: {
     two_sided = property.bool_value();
     return true;
   }
+  }
 
   return false;
 }
@@ -148,35 +192,37 @@ auto Shader::set_property(const Property &property) -> bool {
     return true;
   }
 
-  if (property.name == "Diffuse") {
+  switch (property.name.id) {
+  case "Diffuse"_name: {
     diffuse.from_property(property, archive);
     return true;
   }
 
-  if (property.name == "OutputBlending") {
+  case "OutputBlending"_name: {
     output_blending = static_cast<OutputBlending>(property.uint8_t_value);
     return true;
   }
 
-  if (property.name == "AlphaTest") {
+  case "AlphaTest"_name: {
     alpha_test = property.bool_value();
     return true;
   }
 
-  if (property.name == "AlphaRef") {
+  case "AlphaRef"_name: {
     alpha_ref = property.uint8_t_value;
     return true;
   }
 
-  if (property.name == "TreatAsTwoSided") {
+  case "TreatAsTwoSided"_name: {
     treat_as_two_sided = property.bool_value();
     return true;
   }
 
-  if (property.name == "TwoSided") {
+  case "TwoSided"_name: {
     two_sided = property.bool_value();
     return true;
   }
+  }
 
   return false;
 }
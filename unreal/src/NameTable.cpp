@@ -0,0 +1,24 @@
+#include "pch.h"
+
+#include <unreal/NameTable.h>
+
+namespace unreal {
+
+auto NameTable::instance() -> NameTable & {
+  static NameTable name_table;
+  return name_table;
+}
+
+auto NameTable::name(std::string_view string) -> Name {
+  const auto id = name_id(string);
+
+  std::lock_guard lock{m_mutex};
+
+  const auto &stored = m_names.try_emplace(id, string).first->second;
+  ASSERT(stored == string, "Unreal",
+         "Name ID collision: " << stored << " and " << string);
+
+  return Name{stored.data(), stored.length()};
+}
+
+} // namespace unreal
@@ -10,15 +10,14 @@ void Object::deserialize() {
   }
 
   if ((flags & RF_Native) == 0) {
-    const auto properties = archive.property_extractor.extract_properties();
-
-    for (const auto &property : properties) {
-      if (!set_property(property)) {
-        utils::Log(utils::LOG_DEBUG, "Unreal")
-            << "Unconsumed property: " << property.name << std::endl
-            << std::endl;
-      }
-    }
+    archive.property_extractor.extract_properties(
+        [this](const Property &property) {
+          if (!set_property(property)) {
+            utils::Log(utils::LOG_DEBUG, "Unreal")
+                << "Unconsumed property: " << property.name << std::endl
+                << std::endl;
+          }
+        });
   }
 }
 
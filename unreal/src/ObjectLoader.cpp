@@ -12,15 +12,58 @@
 
 namespace unreal {
 
+using ObjectFactory = auto (*)(Archive &archive) -> std::shared_ptr<Object>;
+
+template <typename T>
+static auto make_object(Archive &archive) -> std::shared_ptr<Object> {
+  return std::make_shared<T>(archive);
+}
+
+struct ObjectClass {
+  NameId name_id;
+  ObjectFactory factory;
+
+  // Needed for collision geometry.
+  bool collision;
+};
+
+static constexpr std::array OBJECT_CLASSES = {
+    ObjectClass{"Model"_name, make_object<Model>, true},
+    ObjectClass{"Texture"_name, make_object<Texture>, true},
+    ObjectClass{"FinalBlend"_name, make_object<FinalBlend>, false},
+    ObjectClass{"Shader"_name, make_object<Shader>, false},
+    ObjectClass{"StaticMesh"_name, make_object<StaticMesh>, true},
+    ObjectClass{"TerrainInfo"_name, make_object<TerrainInfoActor>, true},
+    ObjectClass{"Level"_name, make_object<Level>, true},
+    ObjectClass{"Brush"_name, make_object<BrushActor>, true},
+    ObjectClass{"BlockingVolume"_name, make_object<BlockingVolumeActor>,
+                true},
+    ObjectClass{"WaterVolume"_name, make_object<WaterVolumeActor>, true},
+    ObjectClass{"StaticMeshActor"_name, make_object<StaticMeshActor>, true},
+    ObjectClass{"MovableStaticMeshActor"_name, make_object<StaticMeshActor>,
+                true},
+    ObjectClass{"L2MovableStaticMeshActor"_name,
+                make_object<StaticMeshActor>, true},
+};
+
+static auto find_object_class(NameId name_id) -> const ObjectClass * {
+  const auto object_class =
+      std::find_if(OBJECT_CLASSES.begin(), OBJECT_CLASSES.end(),
+                   [name_id](const ObjectClass &object_class) {
+                     return object_class.name_id == name_id;
+                   });
+
+  return object_class != OBJECT_CLASSES.end() ? &*object_class : nullptr;
+}
+
 auto ObjectLoader::load_object(const ObjectImport &import) const
     -> std::shared_ptr<Object> {
 
-  for (auto &object_export : m_archive.export_map) {
-    if (object_export.object_name == import.object_name &&
-        object_export.class_name == import.class_name &&
-        object_export.class_name != "Package") {
-      return export_object(object_export);
-    }
+  auto *object_export =
+      m_archive.find_export(import.object_name, import.class_name);
+
+  if (object_export != nullptr) {
+    return export_object(*object_export);
   }
 
   utils::Log(utils::LOG_WARN, "Unreal")
@@ -48,8 +91,8 @@ auto ObjectLoader::load_object(Index index) const -> std::shared_ptr<Object> {
           &m_archive.import_map[-package_import->package_index - 1];
     } while (package_import->package_index != 0);
 
-    auto *archive =
-        m_archive_loader.load_archive(std::string{package_import->object_name});
+    auto *archive = m_archive_loader.load_imported_archive(
+        std::string{package_import->object_name}, m_archive);
 
     if (archive == nullptr) {
       return nullptr;
@@ -68,39 +111,94 @@ auto ObjectLoader::load_object(Index index) const -> std::shared_ptr<Object> {
   return nullptr;
 }
 
+auto ObjectLoader::export_objects(
+    const std::vector<ObjectExport *> &object_exports) const
+    -> std::vector<std::shared_ptr<Object>> {
+
+  std::vector<std::shared_ptr<Object>> objects(object_exports.size());
+
+  // Not worth starting threads.
+  if (object_exports.size() < PARALLEL_EXPORT_THRESHOLD) {
+    for (std::size_t i = 0; i < object_exports.size(); ++i) {
+      objects[i] = export_object(*object_exports[i]);
+    }
+
+    return objects;
+  }
+
+  // Packages imported by workers are kept by the caller's pin, or until
+  // objects are exported if there is none.
+  auto *caller_pin = m_archive_loader.current_pin();
+
+  utils::ThreadPool pool;
+  std::atomic_size_t next_export = 0;
+  std::vector<std::future<void>> futures;
+
+  for (std::size_t i = 0; i < pool.thread_count(); ++i) {
+    futures.push_back(pool.submit([this, &object_exports, &objects,
+                                   &next_export, caller_pin] {
+      const auto pin = m_archive_loader.pin(caller_pin);
+
+      for (auto j = next_export++; j < object_exports.size();
+           j = next_export++) {
+
+        objects[j] = export_object(*object_exports[j]);
+      }
+    }));
+  }
+
+  for (auto &future : futures) {
+    future.get();
+  }
+
+  return objects;
+}
+
 auto ObjectLoader::export_object(ObjectExport &object_export) const
     -> std::shared_ptr<Object> {
 
-  if (object_export.object != nullptr) {
-    return object_export.object;
+  std::promise<std::shared_ptr<Object>> promise;
+  std::shared_future<std::shared_ptr<Object>> future;
+  auto loading = false;
+
+  {
+    std::lock_guard lock{m_mutex};
+
+    if (!object_export.object.valid()) {
+      object_export.object = promise.get_future().share();
+      loading = true;
+    }
+
+    future = object_export.object;
   }
 
+  if (loading) {
+    try {
+      promise.set_value(create_object(object_export));
+    } catch (...) {
+      // Waiters get the error, the next export retries.
+      {
+        std::lock_guard lock{m_mutex};
+        object_export.object = {};
+      }
+
+      promise.set_exception(std::current_exception());
+      throw;
+    }
+  }
+
+  return future.get();
+}
+
+auto ObjectLoader::create_object(const ObjectExport &object_export) const
+    -> std::shared_ptr<Object> {
+
   std::shared_ptr<Object> object;
 
-  if (object_export.class_name == "Model") {
-    object = std::make_shared<Model>(m_archive);
-  } else if (object_export.class_name == "Texture") {
-    object = std::make_shared<Texture>(m_archive);
-  } else if (object_export.class_name == "FinalBlend") {
-    object = std::make_shared<FinalBlend>(m_archive);
-  } else if (object_export.class_name == "Shader") {
-    object = std::make_shared<Shader>(m_archive);
-  } else if (object_export.class_name == "StaticMesh") {
-    object = std::make_shared<StaticMesh>(m_archive);
-  } else if (object_export.class_name == "TerrainInfo") {
-    object = std::make_shared<TerrainInfoActor>(m_archive);
-  } else if (object_export.class_name == "Level") {
-    object = std::make_shared<Level>(m_archive);
-  } else if (object_export.class_name == "Brush") {
-    object = std::make_shared<BrushActor>(m_archive);
-  } else if (object_export.class_name == "BlockingVolume") {
-    object = std::make_shared<BlockingVolumeActor>(m_archive);
-  } else if (object_export.class_name == "WaterVolume") {
-    object = std::make_shared<WaterVolumeActor>(m_archive);
-  } else if (object_export.class_name == "StaticMeshActor" ||
-             object_export.class_name == "MovableStaticMeshActor" ||
-             object_export.class_name == "L2MovableStaticMeshActor") {
-    object = std::make_shared<StaticMeshActor>(m_archive);
+  const auto *object_class = find_object_class(object_export.class_name.id);
+
+  if (object_class != nullptr) {
+    object = object_class->factory(m_archive);
   } else {
     utils::Log(utils::LOG_WARN, "Unreal")
         << "Unsupported object type: " << object_export.class_name << std::endl;
@@ -110,15 +208,21 @@ auto ObjectLoader::export_object(ObjectExport &object_export) const
   object->name = object_export.object_name;
   object->flags = object_export.object_flags;
 
-  if (object_export.serial_size > 0) {
-    static_cast<std::istream &>(m_archive).seekg(
-        object_export.serial_offset.value);
-  }
+  // Own read position, other exports can be deserialized at the same time.
+  const Archive::Cursor cursor{m_archive,
+                               object_export.serial_size > 0
+                                   ? object_export.serial_offset.value
+                                   : m_archive.tell()};
 
-  object->deserialize();
+  // Objects not needed by the profile are left with default values.
+  const auto needed = m_archive.profile != LoadProfile::CollisionOnly ||
+                      (object_class != nullptr && object_class->collision);
+
+  if (needed) {
+    object->deserialize();
+  }
 
-  object_export.object = object;
-  return object_export.object;
+  return object;
 }
 
 } // namespace unreal
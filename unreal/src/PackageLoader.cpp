@@ -4,10 +4,10 @@
 
 namespace unreal {
 
-auto PackageLoader::load_package(const std::string &name) const
+auto PackageLoader::load_package(const std::string &name, bool prefetch) const
     -> std::optional<Package> {
 
-  auto *archive = m_archive_loader.load_archive(name);
+  auto *archive = m_archive_loader.load_archive(name, prefetch);
 
   if (archive == nullptr) {
     return {};
@@ -16,4 +16,22 @@ auto PackageLoader::load_package(const std::string &name) const
   return Package{*archive};
 }
 
+auto PackageLoader::load_packages(const std::vector<std::string> &names,
+                                  bool prefetch) const
+    -> std::vector<std::optional<Package>> {
+
+  std::vector<std::optional<Package>> packages;
+  packages.reserve(names.size());
+
+  for (auto *archive : m_archive_loader.load_archives(names, prefetch)) {
+    if (archive != nullptr) {
+      packages.emplace_back(Package{*archive});
+    } else {
+      packages.emplace_back();
+    }
+  }
+
+  return packages;
+}
+
 } // namespace unreal
@@ -8,20 +8,39 @@ auto Property::bool_value() const -> bool {
   return type == PropertyType::Bool && is_array == 1;
 }
 
-auto Property::subproperty(const std::string &name, std::size_t index) const
-    -> Property {
+auto Property::subproperty(std::string_view name, std::size_t index) const
+    -> const Property & {
 
-  ASSERT(index < subproperties.size(), "Index out of bounds");
-  const auto &map = subproperties[index];
-  const auto pair = map.find(name);
+  static const Property empty{};
 
-  if (pair == map.end()) {
+  ASSERT(arena != nullptr && index < element_count, "Unreal",
+         "Index out of bounds");
+
+  // The last one wins if names are duplicated.
+  const auto id = name_id(name);
+  const Property *found = nullptr;
+
+  for (auto i = arena->elements[first_element + index];
+       i != PropertyArena::NONE; i = arena->properties[i].next) {
+
+    if (arena->properties[i].name.id == id) {
+      found = &arena->properties[i];
+    }
+  }
+
+  if (found == nullptr) {
     utils::Log(utils::LOG_WARN, "Unreal")
         << "Can't find property: " << name << std::endl;
-    return {};
+    return empty;
   }
 
-  return pair->second;
+  return *found;
+}
+
+void PropertyArena::truncate(std::size_t property_count,
+                             std::size_t element_count) {
+  properties.resize(property_count);
+  elements.resize(element_count);
 }
 
 } // namespace unreal
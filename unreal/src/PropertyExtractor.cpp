@@ -6,27 +6,11 @@
 
 namespace unreal {
 
-auto PropertyExtractor::extract_properties() const -> std::vector<Property> {
-  std::vector<Property> properties;
-
-  while (true) {
-    Property property{};
-    deserialize(property);
-
-    if (property.name == Name::NONE) {
-      break;
-    }
-
-    properties.push_back(std::move(property));
-  }
-
-  return properties;
-}
-
 void PropertyExtractor::deserialize(Property &property) const {
+  property.next = PropertyArena::NONE;
   m_archive >> property.name;
 
-  if (property.name == Name::NONE) {
+  if (property.name.is_none()) {
     return;
   }
 
@@ -46,8 +30,6 @@ void PropertyExtractor::deserialize(Property &property) const {
     m_archive >> property.array_index;
   }
 
-  std::istream &input = m_archive;
-
   switch (property.type) {
   case PropertyType::Byte: {
     m_archive >> property.uint8_t_value;
@@ -63,40 +45,45 @@ void PropertyExtractor::deserialize(Property &property) const {
     m_archive >> property.index_value;
   } break;
   case PropertyType::Array: {
-    const auto start_position = input.tellg();
+    const auto start_position = m_archive.tell();
     m_archive >> property.array_size;
-    const auto size_size = input.tellg() - start_position;
+    const auto size_size = m_archive.tell() - start_position;
     const auto array_size = property.size - size_size;
 
-    if (property.name == "Materials") {
-      property.subproperties.reserve(property.array_size);
-      const auto array_start_position = input.tellg();
+    if (property.name.id == "Materials"_name) {
+      const auto array_start_position = m_archive.tell();
 
-      for (auto i = 0; i < property.array_size; ++i) {
-        property.subproperties.push_back(extract_properties_map());
-      }
+      property.arena = &thread_arena();
+      property.element_count =
+          static_cast<std::uint32_t>(std::max(property.array_size.value, 0));
+      property.first_element = extract_elements(property.element_count);
 
-      const auto array_end_position = input.tellg();
+      const auto array_end_position = m_archive.tell();
       ASSERT((array_end_position - array_start_position) == array_size,
              "Unreal", "Invalid property array");
     } else {
-      property.data_value.resize(array_size);
-      input.read(reinterpret_cast<char *>(property.data_value.data()),
-                 array_size);
+      property.data_value = m_archive.view(array_size);
     }
 
   } break;
   case PropertyType::Struct: {
-    if (property.struct_name == "Rotator") {
+    switch (property.struct_name.id) {
+    case "Rotator"_name: {
       m_archive >> property.rotator_value;
-    } else if (property.struct_name == "Vector") {
+    } break;
+    case "Vector"_name: {
       m_archive >> property.vector_value;
-    } else if (property.struct_name == "TerrainLayer") {
-      property.subproperties.push_back(extract_properties_map());
-    } else {
+    } break;
+    case "TerrainLayer"_name: {
+      property.arena = &thread_arena();
+      property.element_count = 1;
+      property.first_element = extract_elements(property.element_count);
+    } break;
+    default: {
       utils::Log(utils::LOG_DEBUG, "Unreal")
           << "Skipping struct: " << property.struct_name << std::endl;
-      input.seekg(property.size, std::ios::cur);
+      m_archive.skip(property.size);
+    }
     }
   } break;
   case PropertyType::Vector: {
@@ -109,7 +96,7 @@ void PropertyExtractor::deserialize(Property &property) const {
     utils::Log(utils::LOG_DEBUG, "Unreal")
         << "Skipping property type: " << static_cast<int>(property.type)
         << std::endl;
-    input.seekg(property.size, std::ios::cur);
+    m_archive.skip(property.size);
   }
   }
 }
@@ -152,24 +139,56 @@ auto PropertyExtractor::extract_size(std::uint8_t size_type) const
   return size;
 }
 
-auto PropertyExtractor::extract_properties_map() const
-    -> std::unordered_map<std::string, Property> {
+auto PropertyExtractor::thread_arena() -> PropertyArena & {
+  thread_local PropertyArena arena;
+  return arena;
+}
 
-  std::unordered_map<std::string, Property> map;
-  const auto properties = extract_properties();
+auto PropertyExtractor::extract_elements(std::uint32_t count) const
+    -> std::uint32_t {
 
-  for (const auto &property : properties) {
-    const auto name = std::string{property.name};
+  auto &arena = thread_arena();
 
-    if (map.find(name) == map.end()) {
-      utils::Log(utils::LOG_DEBUG, "Unreal")
-          << "Property already exists: " << name << std::endl;
+  // Reserve slots first, nested structs add own elements after them.
+  const auto first_element =
+      static_cast<std::uint32_t>(arena.elements.size());
+  arena.elements.resize(first_element + count, PropertyArena::NONE);
+
+  for (std::uint32_t i = 0; i < count; ++i) {
+    const auto element = extract_element();
+    arena.elements[first_element + i] = element;
+  }
+
+  return first_element;
+}
+
+auto PropertyExtractor::extract_element() const -> std::uint32_t {
+  auto &arena = thread_arena();
+  auto first = PropertyArena::NONE;
+  auto last = PropertyArena::NONE;
+
+  while (true) {
+    Property property{};
+    deserialize(property);
+
+    if (property.name.is_none()) {
+      break;
+    }
+
+    // Nested properties are already in the arena, so index is taken after.
+    const auto index = static_cast<std::uint32_t>(arena.properties.size());
+    arena.properties.push_back(property);
+
+    if (last == PropertyArena::NONE) {
+      first = index;
+    } else {
+      arena.properties[last].next = index;
     }
 
-    map[name] = property;
+    last = index;
   }
 
-  return map;
+  return first;
 }
 
 } // namespace unreal
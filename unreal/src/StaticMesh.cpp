@@ -44,9 +44,35 @@ auto operator>>(Archive &archive, StaticMeshIndexStream &stream) -> Archive & {
 void StaticMesh::deserialize() {
   Primitive::deserialize();
 
-  archive >> surfaces >> bounding_box >> vertex_stream >> color_stream >>
-      alpha_stream >> uv_stream >> index_stream >> wireframe_index_stream >>
-      collision_model;
+  archive >> surfaces >> bounding_box >> vertex_stream;
+
+  if (archive.profile == LoadProfile::CollisionOnly) {
+    // Color, alpha and UV streams.
+    for (auto i = 0; i < 2; ++i) {
+      archive.skip_array(sizeof(Color));
+      archive.skip(sizeof(std::uint32_t));
+    }
+
+    Index uv_stream_count{};
+    archive >> uv_stream_count;
+
+    for (auto i = 0; i < uv_stream_count; ++i) {
+      archive.skip_array(sizeof(StaticMeshUV));
+      archive.skip(sizeof(std::uint32_t) * 2);
+    }
+
+    archive >> index_stream;
+
+    // Wireframe index stream.
+    archive.skip_array(sizeof(std::uint16_t));
+    archive.skip(sizeof(std::uint32_t));
+
+    archive >> collision_model;
+    return;
+  }
+
+  archive >> color_stream >> alpha_stream >> uv_stream >> index_stream >>
+      wireframe_index_stream >> collision_model;
 }
 
 auto StaticMesh::set_property(const Property &property) -> bool {
@@ -54,7 +80,8 @@ auto StaticMesh::set_property(const Property &property) -> bool {
     return true;
   }
 
-  if (property.name == "Materials") {
+  switch (property.name.id) {
+  case "Materials"_name: {
     for (auto i = 0; i < property.array_size.value; ++i) {
       StaticMeshMaterial material{};
 
@@ -69,20 +96,21 @@ auto StaticMesh::set_property(const Property &property) -> bool {
     return true;
   }
 
-  if (property.name == "UseSimpleLineCollision") {
+  case "UseSimpleLineCollision"_name: {
     use_simple_line_collision = property.bool_value();
     return true;
   }
 
-  if (property.name == "UseSimpleBoxCollision") {
+  case "UseSimpleBoxCollision"_name: {
     use_simple_box_collision = property.bool_value();
     return true;
   }
 
-  if (property.name == "UseSimpleKarmaCollision") {
+  case "UseSimpleKarmaCollision"_name: {
     use_simple_karma_collision = property.bool_value();
     return true;
   }
+  }
 
   return false;
 }
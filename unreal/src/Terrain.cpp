@@ -9,37 +9,38 @@ auto TerrainInfoActor::set_property(const Property &property) -> bool {
     return true;
   }
 
-  if (property.name == "TerrainMap") {
+  switch (property.name.id) {
+  case "TerrainMap"_name: {
     terrain_map.from_property(property, archive);
     return true;
   }
 
-  if (property.name == "TerrainScale") {
+  case "TerrainScale"_name: {
     terrain_scale = property.vector_value;
     return true;
   }
 
-  if (property.name == "QuadVisibilityBitmap") {
+  case "QuadVisibilityBitmap"_name: {
     quad_visibility_bitmap.insert(property.data_value);
     return true;
   }
 
-  if (property.name == "EdgeTurnBitmap") {
+  case "EdgeTurnBitmap"_name: {
     edge_turn_bitmap.insert(property.data_value);
     return true;
   }
 
-  if (property.name == "MapX") {
+  case "MapX"_name: {
     map_x = property.int32_t_value;
     return true;
   }
 
-  if (property.name == "MapY") {
+  case "MapY"_name: {
     map_y = property.int32_t_value;
     return true;
   }
 
-  if (property.name == "Layers") {
+  case "Layers"_name: {
     TerrainLayer layer{};
 
     layer.texture.from_property(property.subproperty("Texture"), archive);
@@ -57,6 +58,7 @@ auto TerrainInfoActor::set_property(const Property &property) -> bool {
 
     return true;
   }
+  }
 
   return false;
 }
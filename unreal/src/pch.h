@@ -3,23 +3,30 @@
 #include <utils/Assert.h>
 #include <utils/Bitset.h>
 #include <utils/Log.h>
+#include <utils/MappedFile.h>
 #include <utils/NonCopyable.h>
 #include <utils/StreamDump.h>
+#include <utils/ThreadPool.h>
 
+#include <algorithm>
 #include <array>
+#include <atomic>
 #include <bitset>
 #include <cctype>
 #include <cstddef>
 #include <cstdint>
 #include <filesystem>
 #include <fstream>
+#include <future>
 #include <iostream>
 #include <limits>
 #include <memory>
+#include <mutex>
 #include <numbers>
 #include <optional>
 #include <sstream>
 #include <string>
+#include <thread>
 #include <unordered_map>
 #include <unordered_set>
 #include <utility>
@@ -2,6 +2,7 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <span>
 #include <vector>
 
 namespace utils {
@@ -11,7 +12,7 @@ public:
   auto size() const -> std::size_t;
   auto operator[](std::size_t index) const -> bool;
 
-  void insert(const std::vector<std::uint8_t> &data);
+  void insert(std::span<const std::uint8_t> data);
 
 private:
   std::vector<std::uint8_t> m_data;
@@ -4,17 +4,36 @@
 
 #include <llvm/Endian.h>
 
+#include <bit>
+#include <cstddef>
 #include <cstdint>
 #include <istream>
+#include <type_traits>
 
 namespace utils {
 
-// std::istream packed_endian_specific_integral extraction.
-template <typename value_type, llvm::endianness endian, llvm::alignment align>
+// Types stored in the stream exactly as in memory, arrays of them are
+// extracted with a single read. Specialize for packed structures.
+template <typename T>
+struct BulkExtractable
+    : std::bool_constant<std::endian::native == std::endian::little &&
+                         std::is_arithmetic_v<T> && !std::is_same_v<T, bool>> {
+};
+
+// Structure of `size` bytes without padding, made of little endian fields.
+template <typename T, std::size_t size>
+struct PackedLittleEndian
+    : std::bool_constant<std::endian::native == std::endian::little &&
+                         std::is_trivially_copyable_v<T> && sizeof(T) == size> {
+};
+
+// packed_endian_specific_integral extraction from any stream with `read`.
+template <typename IStreamT, typename value_type, llvm::endianness endian,
+          llvm::alignment align>
 auto operator>>(
-    std::istream &input_stream,
+    IStreamT &input_stream,
     llvm::detail::packed_endian_specific_integral<value_type, endian, align>
-        &integral) -> std::istream & {
+        &integral) -> IStreamT & {
 
   input_stream.read(reinterpret_cast<char *>(integral.value),
                     sizeof(integral.value));
@@ -55,6 +74,21 @@ struct ExtractArrayHelper {
     const std::int32_t size = size_value;
 
     ASSERT(size >= 0, "Utils", "Size can't be negative");
+
+    using ValueT = typename StoreToT::value_type;
+
+    if constexpr (std::is_same_v<ExtractElementAsT, ValueT> &&
+                  BulkExtractable<ValueT>::value) {
+      store_to.resize(size);
+
+      if (size > 0) {
+        input_stream.read(reinterpret_cast<char *>(store_to.data()),
+                          size * sizeof(ValueT));
+      }
+
+      return input_stream;
+    }
+
     store_to.reserve(size);
 
     for (auto i = 0; i < size; ++i) {
@@ -81,8 +115,7 @@ struct ExtractArrayHelper<ExtractSizeAsT, llvm::ulittle8_t, StoreToT> {
     store_to.resize(size);
 
     if (size > 0) {
-      static_cast<std::istream &>(input_stream)
-          .read(reinterpret_cast<char *>(store_to.data()), size);
+      input_stream.read(reinterpret_cast<char *>(store_to.data()), size);
     }
 
     return input_stream;
@@ -108,9 +141,8 @@ struct ExtractArrayHelper<
     store_to.resize(size);
 
     if (size > 0) {
-      static_cast<std::istream &>(input_stream)
-          .read(reinterpret_cast<char *>(store_to.data()),
-                size * sizeof(PESIT));
+      input_stream.read(reinterpret_cast<char *>(store_to.data()),
+                        size * sizeof(PESIT));
     }
 
     return input_stream;
@@ -0,0 +1,32 @@
+#pragma once
+
+#include "NonCopyable.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+
+namespace utils {
+
+// Read-only memory mapped file.
+class MappedFile : public NonCopyable {
+public:
+  explicit MappedFile(const std::filesystem::path &path);
+  ~MappedFile();
+
+  auto is_open() const -> bool;
+  auto data() const -> const std::uint8_t *;
+  auto size() const -> std::size_t;
+
+private:
+  const std::uint8_t *m_data;
+  std::size_t m_size;
+  bool m_open;
+
+#if _WIN32
+  void *m_file;
+  void *m_mapping;
+#endif
+};
+
+} // namespace utils
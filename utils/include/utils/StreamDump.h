@@ -1,9 +1,13 @@
 #pragma once
 
-#include <istream>
+#include <cstddef>
+#include <cstdint>
+#include <span>
 
 namespace utils {
 
-void dump(std::istream &input, int line_count = 64, int line_length = 24);
+// Prints `line_count` lines before and after `offset`.
+void dump(std::span<const std::uint8_t> data, std::size_t offset,
+          int line_count = 64, int line_length = 24);
 
 }
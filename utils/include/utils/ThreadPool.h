@@ -0,0 +1,54 @@
+#pragma once
+
+#include "NonCopyable.h"
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace utils {
+
+class ThreadPool : public NonCopyable {
+public:
+  // Zero thread count means hardware concurrency.
+  explicit ThreadPool(std::size_t thread_count = 0);
+  ~ThreadPool();
+
+  template <typename F>
+  auto submit(F &&task) -> std::future<std::invoke_result_t<F>> {
+    using R = std::invoke_result_t<F>;
+
+    auto packaged_task =
+        std::make_shared<std::packaged_task<R()>>(std::forward<F>(task));
+    auto future = packaged_task->get_future();
+
+    {
+      std::lock_guard lock{m_mutex};
+      m_tasks.emplace_back([packaged_task] { (*packaged_task)(); });
+    }
+
+    m_condition.notify_one();
+    return future;
+  }
+
+  auto thread_count() const -> std::size_t;
+
+private:
+  std::vector<std::thread> m_threads;
+  std::deque<std::function<void()>> m_tasks;
+  std::mutex m_mutex;
+  std::condition_variable m_condition;
+  bool m_stopping;
+
+  void work();
+};
+
+} // namespace utils
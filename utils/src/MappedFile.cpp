@@ -0,0 +1,117 @@
+#include <utils/MappedFile.h>
+
+#if _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace utils {
+
+#if _WIN32
+
+MappedFile::MappedFile(const std::filesystem::path &path)
+    : m_data{nullptr}, m_size{0}, m_open{false}, m_file{INVALID_HANDLE_VALUE},
+      m_mapping{nullptr} {
+
+  m_file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                       OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+
+  if (m_file == INVALID_HANDLE_VALUE) {
+    return;
+  }
+
+  LARGE_INTEGER size{};
+
+  if (GetFileSizeEx(m_file, &size) == 0) {
+    return;
+  }
+
+  m_size = static_cast<std::size_t>(size.QuadPart);
+  m_open = true;
+
+  // Empty files can't be mapped.
+  if (m_size == 0) {
+    return;
+  }
+
+  m_mapping = CreateFileMappingW(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+
+  if (m_mapping == nullptr) {
+    m_open = false;
+    return;
+  }
+
+  m_data = static_cast<const std::uint8_t *>(
+      MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+  m_open = m_data != nullptr;
+}
+
+MappedFile::~MappedFile() {
+  if (m_data != nullptr) {
+    UnmapViewOfFile(m_data);
+  }
+
+  if (m_mapping != nullptr) {
+    CloseHandle(m_mapping);
+  }
+
+  if (m_file != INVALID_HANDLE_VALUE) {
+    CloseHandle(m_file);
+  }
+}
+
+#else
+
+MappedFile::MappedFile(const std::filesystem::path &path)
+    : m_data{nullptr}, m_size{0}, m_open{false} {
+
+  const auto file = open(path.c_str(), O_RDONLY);
+
+  if (file < 0) {
+    return;
+  }
+
+  struct stat status {};
+
+  if (fstat(file, &status) == 0) {
+    m_size = static_cast<std::size_t>(status.st_size);
+    m_open = true;
+
+    // Empty files can't be mapped.
+    if (m_size > 0) {
+      auto *data = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, file, 0);
+
+      if (data != MAP_FAILED) {
+        madvise(data, m_size, MADV_SEQUENTIAL);
+        m_data = static_cast<const std::uint8_t *>(data);
+      } else {
+        m_open = false;
+      }
+    }
+  }
+
+  // Mapping stays valid after the descriptor is closed.
+  close(file);
+}
+
+MappedFile::~MappedFile() {
+  if (m_data != nullptr) {
+    munmap(const_cast<std::uint8_t *>(m_data), m_size);
+  }
+}
+
+#endif
+
+auto MappedFile::is_open() const -> bool { return m_open; }
+
+auto MappedFile::data() const -> const std::uint8_t * { return m_data; }
+
+auto MappedFile::size() const -> std::size_t { return m_size; }
+
+} // namespace utils
@@ -6,14 +6,22 @@
 
 namespace utils {
 
-void dump(std::istream &input, int line_count, int line_length) {
-  const auto byte_count = line_count * line_length * 2;
+void dump(std::span<const std::uint8_t> data, std::size_t offset,
+          int line_count, int line_length) {
 
-  const auto offset = input.tellg();
+  const auto byte_count = line_count * line_length * 2;
   auto buffer = std::make_unique<char[]>(byte_count);
 
-  input.seekg(-byte_count / 2, std::ios::cur);
-  input.read(buffer.get(), byte_count);
+  // Bytes out of data bounds are zeroes.
+  const auto start = static_cast<std::int64_t>(offset) - byte_count / 2;
+
+  for (auto i = 0; i < byte_count; ++i) {
+    const auto position = start + i;
+
+    if (position >= 0 && static_cast<std::size_t>(position) < data.size()) {
+      buffer[i] = static_cast<char>(data[position]);
+    }
+  }
 
   {
     printf("\n");
@@ -95,8 +103,6 @@ void dump(std::istream &input, int line_count, int line_length) {
 
     printf("\n");
   }
-
-  input.seekg(offset);
 }
 
 } // namespace utils
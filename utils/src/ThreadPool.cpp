@@ -0,0 +1,55 @@
+#include <utils/ThreadPool.h>
+
+#include <algorithm>
+
+namespace utils {
+
+ThreadPool::ThreadPool(std::size_t thread_count) : m_stopping{false} {
+  if (thread_count == 0) {
+    thread_count = std::max(std::thread::hardware_concurrency(), 1u);
+  }
+
+  for (std::size_t i = 0; i < thread_count; ++i) {
+    m_threads.emplace_back([this] { work(); });
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard lock{m_mutex};
+    m_stopping = true;
+  }
+
+  m_condition.notify_all();
+
+  for (auto &thread : m_threads) {
+    thread.join();
+  }
+}
+
+auto ThreadPool::thread_count() const -> std::size_t {
+  return m_threads.size();
+}
+
+void ThreadPool::work() {
+  while (true) {
+    std::function<void()> task;
+
+    {
+      std::unique_lock lock{m_mutex};
+      m_condition.wait(lock, [this] { return m_stopping || !m_tasks.empty(); });
+
+      // Finish queued tasks before stopping.
+      if (m_tasks.empty()) {
+        return;
+      }
+
+      task = std::move(m_tasks.front());
+      m_tasks.pop_front();
+    }
+
+    task();
+  }
+}
+
+} // namespace utils